@@ -158,7 +158,7 @@ LOWERCODESIZE void adsr_setCVs(struct adsr_s * adsr, uint16_t atk, uint16_t dec,
 void adsr_setGate(struct adsr_s * a, int8_t gate)
 {
 	a->phase=0;
-	a->stageLevel=((uint32_t)a->output<<16)/a->levelCV;
+	a->stageLevel=a->levelCV?((uint32_t)a->output<<16)/a->levelCV:0; // no level before the first note
 
 	if(gate)
 	{
@@ -211,15 +211,8 @@ void adsr_init(struct adsr_s * adsr)
 	memset(adsr,0,sizeof(struct adsr_s));
 }
 
-inline void adsr_update(struct adsr_s * a)
+static FORCEINLINE uint16_t computeOutput(struct adsr_s * a, uint32_t phase)
 {
-	// if bit 24 or higher is set, it's an overflow -> a timed stage is done!
-	
-	if(a->phase>>24)
-		handlePhaseOverflow(a);
-	
-	// compute output level
-	
 	uint16_t o=0;
 	
 	switch(a->stage)
@@ -227,17 +220,17 @@ inline void adsr_update(struct adsr_s * a)
 	case sAttack:
         if (a->shape==1) // exp
         {
-            o=computeShape(a->phase,attackCurveLookup,1);
+            o=computeShape_P(phase,attackCurveLookup,1);
             break;
         }
-        o=a->phase>>8; // 24bit -> 16 bit;
+        o=phase>>8; // 24bit -> 16 bit;
         break;
 	case sDecay:
 	case sRelease:
         if (a->shape == 1) // exp
-            o=UINT16_MAX-computeShape(a->phase,expDecayCurveLookup,1);
+            o=UINT16_MAX-computeShape_P(phase,expDecayCurveLookup,1);
         else // linear
-            o=UINT16_MAX-computeShape(a->phase,ssmDecayCurveLookup,1);
+            o=UINT16_MAX-computeShape_P(phase,ssmDecayCurveLookup,1);
 		break;
 	case sSustain:
 		o=a->sustainCV;
@@ -246,7 +239,33 @@ inline void adsr_update(struct adsr_s * a)
 		;
 	}
 	
-	a->output=scaleU16U16(o,a->stageMul)+a->stageAdd;
+	return scaleU16U16(o,a->stageMul)+a->stageAdd;
+}
+
+uint16_t adsr_getHalfStepOutput(struct adsr_s * a)
+{
+	uint32_t half=a->stageIncrement>>1;
+	uint32_t phase=a->phase;
+
+	// half an increment back from the phase of the next update, which may be
+	// past the end of the stage, or before its start after a gate change
+	phase=phase>half?phase-half:0;
+	if(phase>>24)
+		phase=0xffffff;
+
+	return computeOutput(a,phase);
+}
+
+inline void adsr_update(struct adsr_s * a)
+{
+	// if bit 24 or higher is set, it's an overflow -> a timed stage is done!
+	
+	if(a->phase>>24)
+		handlePhaseOverflow(a);
+	
+	// compute output level
+	
+	a->output=computeOutput(a,a->phase);
 
 	// phase increment
 	
@@ -39,5 +39,8 @@ void adsr_reset(struct adsr_s * adsr);
 void adsr_init(struct adsr_s * adsr);
 void adsr_update(struct adsr_s * adsr);
 
+// output half way between the last adsr_update() and the next, for a higher envelope rate
+uint16_t adsr_getHalfStepOutput(struct adsr_s * adsr);
+
 #endif	/* ADSR_H */
 
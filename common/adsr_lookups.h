@@ -3,7 +3,7 @@
 
 #include "synth.h"
 
-const uint16_t attackCurveLookup[]=
+const PROGMEM uint16_t attackCurveLookup[]=
 {
 	0,494,986,1475,1961,2444,2924,3402,3877,4349,4818,5284,5748,6209,6667,7123,
 	7576,8026,8474,8919,9361,9801,10238,10673,11105,11534,11961,12386,12808,
@@ -28,7 +28,7 @@ const uint16_t attackCurveLookup[]=
 	64384,64501,64618,64733,64848,64963,65076,65189,65302,65413,65524,
 };
 
-const uint16_t expDecayCurveLookup[]=
+const PROGMEM uint16_t expDecayCurveLookup[]=
 {
     // this is a pure exponential function
 	0,1890,3684,5428,7122,8769,10369,11924,13435,14904,16331,17719,19067,
@@ -56,7 +56,7 @@ const uint16_t expDecayCurveLookup[]=
 
 };
 
-const uint16_t ssmDecayCurveLookup[]=
+const PROGMEM uint16_t ssmDecayCurveLookup[]=
 {
 
     // this is a hybrid function, linear at the start and then tailing off exponentially
@@ -10,8 +10,9 @@
 #include "midi.h"
 #include "clock.h"
 #include "seq.h"
+#include "rng.h"
 
-#define ARP_NOTE_MEMORY 128 // must stay>=128 for up/down mode
+#define ARP_NOTE_MEMORY 128
 
 // this flag is used to indicate which of the current arp notes are latched so that these can be
 // removed when latch mode is deactivated while the currently held keys continue to be played:
@@ -21,8 +22,9 @@
 
 static struct
 {
-	uint8_t notes[ARP_NOTE_MEMORY];
-	int16_t noteIndex;
+	uint8_t notes[ARP_NOTE_MEMORY]; // dense, in assignment order (sorted by pitch in up/down mode)
+	uint8_t noteCount;
+	int16_t noteIndex; // index in notes, except for up/down mode, see upDownNext()
 	int16_t previousIndex; // this is used to avoid multiple successive playing of notes (or indices) in random arp
 	uint8_t previousNote;
 	int8_t transpose,previousTranspose;
@@ -31,15 +33,59 @@ static struct
 	arpMode_t mode;
 } arp;
 
-static int8_t isEmpty(void)
+static inline int8_t isEmpty(void)
+{
+	return !arp.noteCount;
+}
+
+static int16_t findNote(uint8_t note) // exact match, held flag included
 {
 	int16_t i;
 	
-	for(i=0;i<ARP_NOTE_MEMORY;++i)
-		if(arp.notes[i]!=ASSIGNER_NO_NOTE)
-			return 0;
+	for(i=0;i<arp.noteCount;++i)
+		if(arp.notes[i]==note)
+			return i;
+	
+	return -1;
+}
+
+static void insertNote(uint8_t note)
+{
+	int16_t i;
 
-	return 1;
+	if(arp.mode!=amUpDown)
+	{
+		if(arp.noteCount<ARP_NOTE_MEMORY)
+			arp.notes[arp.noteCount++]=note;
+		return;
+	}
+	
+	// up/down: one entry per pitch, sorted
+	
+	for(i=0;i<arp.noteCount && (arp.notes[i]&~ARP_NOTE_HELD_FLAG)<note;++i);
+
+	if(i<arp.noteCount && (arp.notes[i]&~ARP_NOTE_HELD_FLAG)==note)
+	{
+		arp.notes[i]=note;
+		return;
+	}
+	
+	if(arp.noteCount>=ARP_NOTE_MEMORY)
+		return;
+	
+	memmove(&arp.notes[i+1],&arp.notes[i],arp.noteCount-i);
+	arp.notes[i]=note;
+	++arp.noteCount;
+}
+
+static void removeNote(int16_t i)
+{
+	--arp.noteCount;
+	memmove(&arp.notes[i],&arp.notes[i+1],arp.noteCount-i);
+	
+	// keep the current position on the same note
+	if(arp.mode!=amUpDown && i<=arp.noteIndex)
+		--arp.noteIndex;
 }
 
 static void finishPreviousNote(void)
@@ -63,16 +109,16 @@ static void killAllNotes(void)
 	arp.previousIndex=-1;
 	arp.previousNote=ASSIGNER_NO_NOTE;
 
-	memset(arp.notes,ASSIGNER_NO_NOTE,ARP_NOTE_MEMORY);
+	arp.noteCount=0;
 	assigner_allKeysOff();
 }
 
 static void killHeldNotes(void)
 {
 	int16_t i;
-	for(i=0;i<ARP_NOTE_MEMORY;++i)
+	for(i=arp.noteCount-1;i>=0;--i)
 		if(arp.notes[i]&ARP_NOTE_HELD_FLAG)
-			arp.notes[i]=ASSIGNER_NO_NOTE;
+			removeNote(i);
 	
 	// gate off for last note
 
@@ -80,6 +126,45 @@ static void killHeldNotes(void)
 		finishPreviousNote();
 }
 
+// Up/down walks notes as if they were in a 128 slots ring: each pitch at its
+// own index going up, at ARP_LAST_NOTE-pitch going down. arp.noteIndex is
+// that slot, the next one is the closest occupied slot after it.
+static int16_t upDownNext(void)
+{
+	int16_t i,p,v,w,res;
+	
+	v=arp.noteIndex;
+
+	do
+	{
+		w=ARP_NOTE_MEMORY;
+		res=-1;
+		
+		for(i=0;i<arp.noteCount;++i)
+		{
+			p=arp.notes[i]&~ARP_NOTE_HELD_FLAG;
+			
+			if(p>v && p<w)
+			{
+				w=p;
+				res=i;
+			}
+			
+			if(ARP_LAST_NOTE-p>v && ARP_LAST_NOTE-p<w)
+			{
+				w=ARP_LAST_NOTE-p;
+				res=i;
+			}
+		}
+		
+		v=(res<0)?-1:w; // past the last slot, cycle
+	}
+	while(res<0 || arp.previousIndex==(ARP_LAST_NOTE-v)); // avoid top/bottom note double playing
+	
+	arp.noteIndex=v;
+	return res;
+}
+
 inline void arp_setMode(arpMode_t mode, int8_t hold)
 {
 	// stop previous assigned notes
@@ -148,60 +233,25 @@ void arp_assignNote(uint8_t note, int8_t on)
 
 		// assign note			
 		
-		if(arp.mode!=amUpDown)
-		{
-			for(i=0;i<ARP_NOTE_MEMORY;++i)
-				if(arp.notes[i]==ASSIGNER_NO_NOTE)
-				{
-					arp.notes[i]=note;
-					break;
-				}
-		}
-		else
-		{
-			arp.notes[note]=note;
-			arp.notes[ARP_LAST_NOTE-note]=note;
-		}
+		insertNote(note);
 	}
 	else
 	{
+		i=findNote(note);
+		if(i<0)
+			return;
+
 		if(arp.hold)
 		{
 			// mark deassigned notes as held
 
-			if(arp.mode!=amUpDown)
-			{
-				for(i=0;i<ARP_NOTE_MEMORY;++i)
-					if(arp.notes[i]==note)
-					{
-						arp.notes[i]|=ARP_NOTE_HELD_FLAG;
-						break;
-					}
-			}
-			else
-			{
-				arp.notes[note]|=ARP_NOTE_HELD_FLAG;
-				arp.notes[ARP_LAST_NOTE-note]|=ARP_NOTE_HELD_FLAG;
-			}
+			arp.notes[i]|=ARP_NOTE_HELD_FLAG;
 		}
 		else
 		{
 			// deassign note if not in hold mode
 
-			if(arp.mode!=amUpDown)
-			{
-				for(i=0;i<ARP_NOTE_MEMORY;++i)
-					if(arp.notes[i]==note)
-					{
-						arp.notes[i]=ASSIGNER_NO_NOTE;
-						break;
-					}
-			}
-			else
-			{
-				arp.notes[note]=ASSIGNER_NO_NOTE;
-				arp.notes[ARP_LAST_NOTE-note]=ASSIGNER_NO_NOTE;
-			}
+			removeNote(i);
 
 			// gate off for last note
 
@@ -213,7 +263,8 @@ void arp_assignNote(uint8_t note, int8_t on)
 
 void arp_update(void)
 {
-	uint8_t n, step;
+	uint8_t n;
+	int16_t i;
 	
 	// arp off -> nothing to do
 	
@@ -234,40 +285,27 @@ void arp_update(void)
 	switch(arp.mode)
 	{
         case amUpDown:
-            do
-                arp.noteIndex=(arp.noteIndex+1)%ARP_NOTE_MEMORY; // cycle through the array
-            while (arp.notes[arp.noteIndex]==ASSIGNER_NO_NOTE || (arp.previousIndex==(ARP_LAST_NOTE-arp.noteIndex))); // add here the avoidance of top/bottom note double playing
+            i=upDownNext();
             break;
         case amAssign:
-            do
-                arp.noteIndex=(arp.noteIndex+1)%ARP_NOTE_MEMORY;
-            while(arp.notes[arp.noteIndex]==ASSIGNER_NO_NOTE);
+            i=arp.noteIndex=(arp.noteIndex+1)%arp.noteCount;
             break;
 
         case amRandom:
-            step=0;
-            for (n=0;n<ARP_NOTE_MEMORY;n++)
-            {
-                if (arp.notes[n]!=ASSIGNER_NO_NOTE) step++;
-            }
-            // n is the random number of notes that will be skipped. Step is always >0 if there is more than one note but alsoways =0 if there is exactly one note
+            // n is the random number of notes that will be skipped, so that the same note isn't played twice in a row
             n=0;
-            if (step>1)
+            if (arp.noteCount>1)
 			{
-				n=(random()%(step-1))+1;
+				n=rng_below(arp.noteCount-1)+1;
 			}
 			if (arp.noteIndex<0) arp.noteIndex=0;
-            while(arp.notes[arp.noteIndex]==ASSIGNER_NO_NOTE || n>0)
-            {
-                arp.noteIndex=(arp.noteIndex+1)%ARP_NOTE_MEMORY;
-                if (arp.notes[arp.noteIndex]!=ASSIGNER_NO_NOTE) n--;
-            }
+            i=arp.noteIndex=(arp.noteIndex+n)%arp.noteCount;
             break;
         default:
             return;
 	}
 	
-	n=arp.notes[arp.noteIndex]&~ARP_NOTE_HELD_FLAG;
+	n=arp.notes[i]&~ARP_NOTE_HELD_FLAG;
 	
 	// send note to assigner, velocity at half (MIDI value 64)
 	
@@ -280,7 +318,7 @@ void arp_update(void)
         midi_sendNoteEvent(n+SCANNER_BASE_NOTE+arp.transpose,1,HALF_RANGE);
     }
 
-	arp.previousNote=arp.notes[arp.noteIndex];
+	arp.previousNote=arp.notes[i];
 	arp.previousTranspose=arp.transpose;
 	arp.previousIndex=arp.noteIndex;
 }
@@ -289,8 +327,6 @@ void arp_init(void)
 {
 	memset(&arp,0,sizeof(arp));
 
-	memset(arp.notes,ASSIGNER_NO_NOTE,ARP_NOTE_MEMORY);
-	
 	arp.noteIndex=-1;
 	arp.previousNote=ASSIGNER_NO_NOTE;
 }
@@ -20,11 +20,14 @@ struct allocation_s
 static struct
 {
 	uint8_t noteStates[16]; // 1 bit per note, 128 notes
+	uint8_t heldNotes[128]; // same notes, sorted by pitch
+	uint8_t heldCount;
 	uint16_t noteVelocities[128];
 	struct allocation_s allocation[SYNTH_VOICE_COUNT];
 	uint8_t patternOffsets[SYNTH_VOICE_COUNT];
 	assignerPriority_t priority;
 	uint8_t voiceMask;
+	int8_t reservedVoice; // -1: none, see assigner_reserveVoice
 	int8_t mono; // this state variable says if we're in unison mode (mono=1) of poly (mono=0)
 	int8_t hold; // this state variable says, if notes are held (sustained)
     int8_t latch; // this state variable say, if in unison mode the latch is on (foot down)
@@ -34,15 +37,41 @@ static const uint8_t bit2mask[8] = {1,2,4,8,16,32,64,128};
 
 static inline void setNoteState(uint8_t note, int8_t gate)
 {
-	uint8_t *bf,mask;
+	uint8_t *bf,mask,i;
 	
 	bf=&assigner.noteStates[note>>3];
 	mask=bit2mask[note&7];
 	
 	if(gate)	
+	{
+		if(*bf&mask)
+			return;
 		*bf|=mask;
+		
+		// insert in held notes, keeping pitch order
+		
+		for(i=assigner.heldCount;i>0 && assigner.heldNotes[i-1]>note;--i)
+			assigner.heldNotes[i]=assigner.heldNotes[i-1];
+		assigner.heldNotes[i]=note;
+		++assigner.heldCount;
+	}
 	else
+	{
+		if(!(*bf&mask))
+			return;
 		*bf&=~mask;
+		
+		for(i=0;assigner.heldNotes[i]!=note;++i);
+		--assigner.heldCount;
+		for(;i<assigner.heldCount;++i)
+			assigner.heldNotes[i]=assigner.heldNotes[i+1];
+	}
+}
+
+static inline void clearNoteStates(void)
+{
+	memset(assigner.noteStates,0,sizeof(assigner.noteStates));
+	assigner.heldCount=0;
 }
 
 static inline int8_t getNoteState(uint8_t note)
@@ -72,7 +101,7 @@ static inline uint16_t getNoteVelocity(uint8_t note)
 
 static inline int8_t isVoiceDisabled(int8_t voice)
 {
-	return !(assigner.voiceMask&bit2mask[voice]);
+	return voice==assigner.reservedVoice || !(assigner.voiceMask&bit2mask[voice]);
 }
 
 static inline int8_t getAvailableVoice(uint8_t note, uint32_t timestamp)
@@ -215,7 +244,7 @@ void voicesDone(int8_t releaseNotes)
 		// clear all pending key status too, or we might get a note
 		// seemingly popping up from nowhere later on if there are keys
 		// to release after this call has been performed.
-		memset(assigner.noteStates, 0, sizeof(assigner.noteStates));
+		clearNoteStates();
 }
 
 
@@ -245,7 +274,7 @@ void assigner_allKeysOff(void)
 	// Release all keys and future holds too. This avoids potential
 	// problems with notes seemingly popping up from nowhere due to
 	// reassignment when future keys are released.
-	memset(assigner.noteStates, 0, sizeof(assigner.noteStates));
+	clearNoteStates();
 	assigner.hold=0;
 }
 
@@ -271,6 +300,12 @@ void assigner_setVoiceMask(uint8_t mask)
 	assigner.voiceMask=mask;
 }
 
+void assigner_reserveVoice(int8_t voice)
+{
+	// unlike assigner_setVoiceMask, this doesn't touch the other voices
+	assigner.reservedVoice=voice;
+}
+
 FORCEINLINE int8_t assigner_getAssignment(int8_t voice, uint8_t * note)
 {
 	int8_t a;
@@ -285,13 +320,7 @@ FORCEINLINE int8_t assigner_getAssignment(int8_t voice, uint8_t * note)
 
 int8_t assigner_getAnyPressed(void)
 {
-	int8_t i;
-	int8_t v=0;
-	
-	for(i=0;i<sizeof(assigner.noteStates);++i)
-		v|=assigner.noteStates[i];
-	
-	return v!=0;
+	return assigner.heldCount!=0;
 }
 
 int8_t assigner_getLatestNotePressed(uint8_t * note)
@@ -329,7 +358,7 @@ void assigner_assignNote(uint8_t note, int8_t gate, uint16_t velocity, int8_t ke
 {
 	uint32_t timestamp;
 	uint16_t oldVel;
-	uint8_t restoredNote;
+	uint8_t restoredNote,lo,hi;
 	int8_t v,vi,legato=0;
 	int16_t ni,n;
 	
@@ -350,17 +379,20 @@ reassign:
 			
 			v=0; // in mono mode the note is always associated with voice 0 in the assigner (.allocation)
 
-			if(assigner.priority!=apLast)
-				for(n=0;n<128;++n)
-					if(n!=note && getNoteState(n))
-					{
-						if (note>n && assigner.priority==apLow) // ignore higher notes is priority low
-							return;
-						if (note<n && assigner.priority==apHigh) // ignore lower notes is priority high
-							return;
-						
-						legato=1;
-					}
+			if(assigner.priority!=apLast && assigner.heldCount>1)
+			{
+				// other held notes are at the ends of the pitch ordered list
+				
+				lo=assigner.heldNotes[0];
+				hi=assigner.heldNotes[assigner.heldCount-1];
+
+				if (note>lo && assigner.priority==apLow) // ignore higher notes is priority low
+					return;
+				if (note<hi && assigner.priority==apHigh) // ignore lower notes is priority high
+					return;
+
+				legato=1;
+			}
 		}
 		else
 		{
@@ -410,25 +442,22 @@ reassign:
 
 		// some still triggered notes might have been stolen, find them
 
-		for(ni=0;ni<128;++ni)
+		for(ni=0;ni<assigner.heldCount;++ni)
 		{
 			if(assigner.priority==apHigh)
-				n=127-ni;
+				n=assigner.heldNotes[assigner.heldCount-1-ni];
 			else
-				n=ni;
+				n=assigner.heldNotes[ni];
 			
-			if(getNoteState(n))
-			{
-				for(v=0;v<SYNTH_VOICE_COUNT;++v)
-					if(assigner.allocation[v].assigned && assigner.allocation[v].rootNote==n)
-						break;
-
-				if(v==SYNTH_VOICE_COUNT) // note not assigned to a voice but marked as active
-				{
-					restoredNote=n;
-					oldVel=getNoteVelocity(n);
+			for(v=0;v<SYNTH_VOICE_COUNT;++v)
+				if(assigner.allocation[v].assigned && assigner.allocation[v].rootNote==n)
 					break;
-				}
+
+			if(v==SYNTH_VOICE_COUNT) // note not assigned to a voice but marked as active
+			{
+				restoredNote=n;
+				oldVel=getNoteVelocity(n);
+				break;
 			}
 		}
 
@@ -519,19 +548,15 @@ LOWERCODESIZE void assigner_latchPattern(uint8_t retrigger) // this enters uniso
     //assigner.hold=0;
 	memset(pattern,ASSIGNER_NO_NOTE,SYNTH_VOICE_COUNT);
 	
-	for(i=0;i<128;++i)
-		if(getNoteState(i))
-		{
-			pattern[count]=i;
-			
-			if(count>0)
-				pattern[count]-=pattern[0]; // it's a list of offsets to the root note
-						
-			++count;
-			
-			if(count>=SYNTH_VOICE_COUNT)
-				break;
-		}
+	for(i=0;i<assigner.heldCount && count<SYNTH_VOICE_COUNT;++i)
+	{
+		pattern[count]=assigner.heldNotes[i];
+		
+		if(count>0)
+			pattern[count]-=pattern[0]; // it's a list of offsets to the root note
+					
+		++count;
+	}
 
 	assigner_setPattern(pattern,1);
 
@@ -572,6 +597,7 @@ void assigner_init(void)
 	memset(&assigner,0,sizeof(assigner));
 
 	assigner.voiceMask=0x3f;
+	assigner.reservedVoice=-1;
 	memset(&assigner.patternOffsets[0],ASSIGNER_NO_NOTE,SYNTH_VOICE_COUNT);
 	assigner.patternOffsets[0]=0;
 }
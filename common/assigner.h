@@ -14,6 +14,7 @@ typedef enum
 
 void assigner_setPriority(assignerPriority_t prio);
 void assigner_setVoiceMask(uint8_t mask);
+void assigner_reserveVoice(int8_t voice); // keeps new notes off that voice, -1 -> none
 
 int8_t assigner_getAssignment(int8_t voice, uint8_t * note);
 int8_t assigner_getAnyPressed(void);
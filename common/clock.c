@@ -5,21 +5,125 @@
 #include "clock.h"
 
 #include "storage.h"
+#include "midi.h"
+#include "../xnormidi/midi.h"
+
+#define CLOCK_PERIOD_SHIFT 7 // internal sync period, in 1/128 of 500hz ticks
+#define CLOCK_PULSE 0x10000L // one external clock, external sync phase is in 16.16 clocks
+
+// MIDI clock PLL, times are in 2khz ticks
+#define CLOCK_PLL_TIMEOUT 500 // unlock after 250ms without MIDI clock
+#define CLOCK_PLL_PERIOD_SHIFT 3 // tempo estimate smoothing
+#define CLOCK_PLL_JITTER_SHIFT 4
+#define CLOCK_PLL_MAX_CORRECTION (CLOCK_PULSE/4) // per received clock
+
+// MIDI clock output, internal sync
+#define CLOCK_OUT_PER_STEP 6 // a step is a 16th note
+#define CLOCK_OUT_JITTER_SHIFT 4
 
 struct
 {
-	uint16_t counter,speed;
+	uint32_t phase,increment; // internal sync: fraction of a step, external sync: 16.16 clocks
+	uint16_t speed;
+
+	uint32_t ticks;
+	uint32_t lastPulse;
+	uint32_t period; // 16.16 ticks per clock, smoothed
+	uint32_t jitter; // 16.16 ticks, mean deviation of clock intervals from the period
+	uint32_t pllIncrement; // 16.16 clocks per tick
+	int32_t lag; // 16.16 clocks received minus clocks played
+	int32_t correction; // 16.16 clocks, left to apply
+	uint8_t pendingPulses; // received while unlocked, played as they come
+	int8_t locked;
+
+	uint8_t outSlot; // MIDI clock within the step, last sent
+	uint32_t outPeriod; // 16.16 ticks per sent clock, exact
+	uint32_t lastOut;
+	uint32_t outJitter; // 16.16 ticks, mean deviation of sent clock intervals from outPeriod
+	int8_t running,master; // transport, as last sent
 } clock;
 
+static inline int8_t isMaster(void)
+{
+	return settings.syncMode==smInternal && settings.midiClockOut;
+}
+
+static int8_t advance(uint32_t amount)
+{
+	uint32_t length=(uint32_t)clock.speed<<16;
+
+	if(clock.phase>=length) // reset or shorter divider, step right away
+	{
+		clock.phase=0;
+		return 1;
+	}
+
+	clock.phase+=amount;
+
+	if(clock.phase<length)
+		return 0;
+
+	clock.phase-=length;
+	return 1;
+}
+
+static int8_t pllUpdate(void)
+{
+	int32_t c;
+
+	if(clock.pendingPulses)
+	{
+		--clock.pendingPulses;
+		return advance(CLOCK_PULSE);
+	}
+
+	// play at the estimated tempo, but never more than a clock ahead of what was received
+	if(!clock.locked || clock.lag<=-CLOCK_PULSE)
+		return 0;
+
+	c=clock.correction;
+	if(c>(int32_t)clock.pllIncrement/4)
+		c=clock.pllIncrement/4;
+	else if(c<-(int32_t)clock.pllIncrement/4)
+		c=-(int32_t)clock.pllIncrement/4;
+	clock.correction-=c;
+
+	clock.lag-=clock.pllIncrement+c;
+	return advance(clock.pllIncrement+c);
+}
+
 inline void clock_setSpeed(uint16_t speed)
 {
+	uint16_t period;
+	uint32_t increment=0,outPeriod=0;
 
 	if(speed<1024)
-		clock.speed=UINT16_MAX;
+	{
+		speed=UINT16_MAX;
+	}
 	else if(settings.syncMode==smInternal)
-		clock.speed=exponentialCourse(speed,22000.0f,500.0f);
+	{
+		// in 500hz ticks, fractional, but the clock runs on the 2khz voice tick
+		period=exponentialCourse(speed,EXPONENTIAL_COURSE_RATE(22000.0),500<<CLOCK_PERIOD_SHIFT);
+		speed=period>>CLOCK_PERIOD_SHIFT;
+
+		// a step is 2^32 of phase, 2^32/(period*CLOCK_TICKS_PER_SLOT) split in
+		// two divisions to keep the fraction, CLOCK_TICKS_PER_SLOT is 2^2
+		increment=((UINT32_MAX/period)<<(CLOCK_PERIOD_SHIFT-2))+(((UINT32_MAX%period)<<(CLOCK_PERIOD_SHIFT-2))/period);
+		outPeriod=((uint32_t)period*(CLOCK_TICKS_PER_SLOT*65536L>>CLOCK_PERIOD_SHIFT))/CLOCK_OUT_PER_STEP;
+	}
 	else
-        clock.speed=extClockDividers[(((uint32_t)speed)*16)>>16];
+	{
+		// in external clocks
+		speed=extClockDividers[(((uint32_t)speed)*16)>>16];
+	}
+
+	BLOCK_INT // the clock runs in the interrupt
+	{
+		clock.speed=speed;
+		clock.increment=increment;
+		clock.outPeriod=outPeriod;
+	}
 }
 
 inline uint16_t clock_getSpeed(void)
@@ -27,30 +131,188 @@ inline uint16_t clock_getSpeed(void)
 	return clock.speed;
 }
 
-inline uint16_t clock_getCounter(void)
+inline uint32_t clock_getPhase(void)
 {
-	return clock.counter;
+	uint32_t phase=clock.phase;
+
+	if(settings.syncMode==smInternal || phase>=((uint32_t)clock.speed<<16))
+		return phase;
+
+	return (phase/clock.speed)<<16;
 }
 
 inline void clock_reset(void)
 {
-	clock.counter = INT16_MAX; // not UINT16_MAX, to avoid overflow
+	int8_t master=isMaster();
+
+	BLOCK_INT
+	{
+		clock.phase=UINT32_MAX; // next update starts a step
+		clock.pendingPulses=0;
+		clock.lag=0;
+		clock.correction=0;
+
+		// the first step is the first MIDI clock after the reset
+		clock.outSlot=UINT8_MAX;
+
+		// START rewinds the slaves, only a start from stopped sends it, a
+		// restart while playing (arp retrigger...) keeps their position
+		if(master && !clock.running)
+			midi_sendRealtime(MIDI_START);
+		else if(master && !clock.master)
+			midi_sendRealtime(MIDI_CONTINUE); // clock output enabled while playing
+
+		clock.running=1;
+		clock.master=master;
+	}
+}
+
+void clock_updateTransport(int8_t running)
+{
+	int8_t master=isMaster();
 
+	if(running==clock.running && master==clock.master)
+		return;
+
+	BLOCK_INT
+	{
+		if(running && master && !clock.master)
+			midi_sendRealtime(MIDI_CONTINUE); // clock output enabled while playing
+		else if(clock.running && clock.master && (!running || !master))
+			midi_sendRealtime(MIDI_STOP);
+
+		clock.running=running;
+		clock.master=master;
+	}
 }
 
 inline int8_t clock_update(void)
 {
-	// speed management
+	uint32_t prev=clock.phase;
+	uint8_t slot;
+
+	++clock.ticks;
 
 	if(clock.speed==UINT16_MAX)
 		return 0;
 
-	++clock.counter;
+	if(settings.syncMode==smMIDI)
+		return pllUpdate();
 
-	if(clock.counter<clock.speed)
+	if(!clock.increment)
 		return 0;
 
-	clock.counter=0;
+	clock.phase+=clock.increment;
 
-	return 1;
+	// MIDI clocks run even when stopped, so that slaves follow the tempo
+	if(isMaster())
+	{
+		slot=((clock.phase>>16)*CLOCK_OUT_PER_STEP)>>16;
+		if(slot!=clock.outSlot)
+		{
+			clock.outSlot=slot;
+			midi_sendRealtime(MIDI_CLOCK);
+		}
+	}
+
+	// a step on each phase wrap, what's left is how late the update is compared to the exact step time
+	return clock.phase<prev;
+}
+
+void clock_midiClockSent(void)
+{
+	uint32_t interval;
+	int32_t err;
+
+	interval=clock.ticks-clock.lastOut;
+	clock.lastOut=clock.ticks;
+
+	// skip restarts and tempo jumps
+	if(interval>clock.outPeriod>>15)
+		return;
+
+	err=(int32_t)(interval<<16)-(int32_t)clock.outPeriod;
+	clock.outJitter+=((err<0?-err:err)-(int32_t)clock.outJitter)>>CLOCK_OUT_JITTER_SHIFT;
+}
+
+int8_t clock_externalPulse(void)
+{
+	if(clock.speed==UINT16_MAX)
+		return 0;
+
+	return advance(CLOCK_PULSE);
+}
+
+void clock_midiPulse(void)
+{
+	uint32_t interval;
+	int32_t err;
+
+	BLOCK_INT
+	{
+		interval=clock.ticks-clock.lastPulse;
+		clock.lastPulse=clock.ticks;
+
+		if(interval>CLOCK_PLL_TIMEOUT)
+		{
+			// first clock, start counting right away
+			clock.locked=0;
+			++clock.pendingPulses;
+		}
+		else if(!clock.locked)
+		{
+			// second clock, lock on its interval
+			clock.period=interval<<16;
+			clock.jitter=0;
+			clock.lag=0;
+			clock.correction=0;
+			clock.locked=1;
+			++clock.pendingPulses;
+		}
+		else
+		{
+			err=(int32_t)(interval<<16)-(int32_t)clock.period;
+			clock.period+=err>>CLOCK_PLL_PERIOD_SHIFT;
+			clock.jitter+=((err<0?-err:err)-(int32_t)clock.jitter)>>CLOCK_PLL_JITTER_SHIFT;
+
+			// the received clock is the reference, pull the played phase towards it, bounded
+			clock.lag+=CLOCK_PULSE;
+			clock.correction=clock.lag/8;
+			if(clock.correction>CLOCK_PLL_MAX_CORRECTION)
+				clock.correction=CLOCK_PLL_MAX_CORRECTION;
+			else if(clock.correction<-CLOCK_PLL_MAX_CORRECTION)
+				clock.correction=-CLOCK_PLL_MAX_CORRECTION;
+		}
+
+		if(clock.period)
+			clock.pllIncrement=UINT32_MAX/clock.period;
+	}
+}
+
+uint16_t clock_getMidiBPM(void)
+{
+	uint32_t period;
+
+	BLOCK_INT
+	{
+		period=clock.locked&&clock.ticks-clock.lastPulse<=CLOCK_PLL_TIMEOUT?clock.period:0;
+	}
+
+	if(!period)
+		return 0;
+
+	// 24 clocks per beat
+	return (50000UL<<16)/period;
+}
+
+uint16_t clock_getMidiJitter(void)
+{
+	uint32_t jitter;
+
+	BLOCK_INT
+	{
+		jitter=isMaster()?clock.outJitter:clock.jitter;
+	}
+
+	return (jitter*5)>>16;
 }
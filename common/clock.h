@@ -3,10 +3,22 @@
 
 #include <stdint.h>
 
+#define CLOCK_TICKS_PER_SLOT 4 // clock updates per 500hz tick
+
 void clock_setSpeed(uint16_t speed);
 uint16_t clock_getSpeed(void);
-uint16_t clock_getCounter(void);
+uint32_t clock_getPhase(void);
 void clock_reset(void);
-int8_t clock_update(void);
+int8_t clock_update(void); // on every 2khz tick, returns 1 for a step
+int8_t clock_externalPulse(void); // tape sync, returns 1 for a step
+
+// MIDI sync, clocks are timestamped on reception and played through a PLL
+void clock_midiPulse(void);
+uint16_t clock_getMidiBPM(void); // in tenths, 0 when not locked
+uint16_t clock_getMidiJitter(void); // in tenths of ms, of the sent clock when master
+
+// MIDI clock master, internal sync sends 24ppqn clocks and start/stop/continue
+void clock_updateTransport(int8_t running);
+void clock_midiClockSent(void);
 
 #endif /* CLOCK_H */
@@ -8,6 +8,8 @@
 #define DISPLAY_BLINK_HALF_PERIOD 20
 #define DISPLAY_SCROLL_RATE 15
 
+#define DISPLAY_SCROLL_MAX 50
+
 static struct
 {
 	uint16_t ledOn;
@@ -21,33 +23,45 @@ static struct
 	uint8_t scrollCounter;
 	int8_t scrollPos;
 	int8_t scrollTimes;
+	int8_t scrollLength;
 
 	uint8_t activeCol;
 	uint8_t activeRows[3];
+	volatile int8_t dirty; // activeRows[] must be rebuilt
 
-	char scrollText[50];
+	uint8_t scrollSegs[DISPLAY_SCROLL_MAX]; // scroll text, already mapped to segments
 } display;
 
 static SEG7_DEFAULT_MAP(sevenSeg_map);
 
 void LOWERCODESIZE sevenSeg_scrollText(const char * text, int8_t times)
 {
+	int8_t l;
+
 	display.scrollTimes=times;
 	display.scrollPos=-1;
 	
 	if (text)
 	{
+		// a space before and after the text
+		l=1;
+		while(*text && l<DISPLAY_SCROLL_MAX-1)
+			display.scrollSegs[l++]=map_to_seg7(&sevenSeg_map,*text++);
+		display.scrollSegs[l++]=map_to_seg7(&sevenSeg_map,' ');
+
 		display.scrollTimes=times;
 		display.scrollPos=0;
-		strcpy(&display.scrollText[1],text);
-		strcat(display.scrollText," ");
+		display.scrollLength=l;
 	}
+
+	display.dirty=1;
 }
 
 void LOWERCODESIZE sevenSeg_setAscii(char left, char right)
 {
 	display.sevenSegs[0]=map_to_seg7(&sevenSeg_map,left);
 	display.sevenSegs[1]=map_to_seg7(&sevenSeg_map,right);
+	display.dirty=1;
 }
 
 void LOWERCODESIZE sevenSeg_setNumber(int32_t n)
@@ -72,6 +86,7 @@ void sevenSeg_setRelative(comparator_t comparator)
     {
         display.sevenSegs[1]=map_to_seg7(&sevenSeg_map,*">");
     }
+    display.dirty=1;
 }
 
 int led_getOn(p600LED_t led)
@@ -89,17 +104,26 @@ int led_getBlinking(p600LED_t led)
 void led_set(p600LED_t led, int8_t on, int8_t blinking)
 {
 	uint16_t mask=1<<led; // set a single bit at the position of the LED
+	uint16_t ledOn=display.ledOn,ledBlinking=display.ledBlinking;
 
-    if (!blinking) display.ledBlinking&=~mask; // deactivate blinking of the LED
+    if (!blinking) ledBlinking&=~mask; // deactivate blinking of the LED
     if (on)
     {
-        display.ledOn|=mask; // set it blinking if flag is set
-        if (blinking) display.ledBlinking|=mask;
+        ledOn|=mask; // set it blinking if flag is set
+        if (blinking) ledBlinking|=mask;
     }
 	else
 	{
-		display.ledOn&=~mask; // switch off the LED
+		ledOn&=~mask; // switch off the LED
     }
+
+	// this is called for all LEDs on every UI refresh, only redraw on change
+	if (ledOn==display.ledOn && ledBlinking==display.ledBlinking)
+		return;
+
+	display.ledOn=ledOn;
+	display.ledBlinking=ledBlinking;
+	display.dirty=1;
 }
 
 void display_clear()
@@ -109,20 +133,70 @@ void display_clear()
 	display.ledOn=0;
 	display.ledBlinking=0;
 	display.scrollTimes=0;
+	display.dirty=1;
 }
 
 void display_init()
 {
 	memset(&display,0,sizeof(display));
-	display.scrollText[0]=' ';
+	display.dirty=1;
+}
+
+static void render(void)
+{
+	uint8_t segs[2];
+	uint8_t b;
+	int8_t p2;
+
+	if(display.scrollTimes)
+	{
+		// this sets the characters of position and next position from the text to be displayed
+		p2=display.scrollPos+1;
+		if(p2>=display.scrollLength)
+			p2=0;
+
+		segs[0]=display.scrollSegs[display.scrollPos];
+		segs[1]=display.scrollSegs[p2];
+	}
+	else
+	{
+		// if nothing to scroll, then continue to display current value or content
+		segs[0]=display.sevenSegs[0];
+		segs[1]=display.sevenSegs[1];
+	}
+
+	// this is the way the P600 hardware (the LED matrix) is built:
+	// S&H in three waves,  8 bits in each wave are sent to
+	// 1) 8 button LEDs (all except tune)
+	// 2) the 7 segments of the left display digit + the dot
+	// 3) the 7 segments of the right display digit + the tune LED
+	// other parts of the display (other dots) are not connected
+	// 
+	// see also service manual board 1, LED matrix
+
+	// all the LEDs as set in the bits of ledON (according to enum p600led_t) 
+	// note: this covers all "buttons" except Tune and the display dot (these are the 9th and 10th bit in .ledOn)  
+	b=display.ledOn; // set the bits 
+	if (display.blinkState) b^=display.ledBlinking; // deactivates the dot depending on blink state
+	display.activeRows[0]=b;
+
+	// left digit + the dot
+	b=segs[0]&0x7f; // 7f is the mask that has the 7 elements (and only those) activated 
+	if (led_getOn(plDot)) b|=0x80; // activates the 8th bit (the display dot)
+	if (led_getBlinking(plDot) && display.blinkState) b^=0x80; // deactivates the dot depending on blink state
+	display.activeRows[1]=b;
+
+	// right digit + tune button LED
+	b=segs[1]&0x7f; // 7f is the mask that has the 7 elements (and only those) activated 
+	if (led_getOn(plTune)) b|=0x80; // activates the 8th bit (the tune button LED)
+	if (led_getBlinking(plTune) && display.blinkState) b^=0x80; // deactivates the tune LED depending on blink state
+	display.activeRows[2]=b;
 }
 
 void display_update(int8_t fullUpdate)
 {
 	if(fullUpdate)
 	{
-		uint8_t localSevenSegs[2];
-		
 		// blinker, e.g. set the current state (on or off) according to the counter
 
 		display.blinkCounter++;
@@ -131,74 +205,36 @@ void display_update(int8_t fullUpdate)
 		{
 			display.blinkState=!display.blinkState;
 			display.blinkCounter=0;
+
+			if(display.ledBlinking)
+				display.dirty=1;
 		}
 
 		// scroller
 
-		if(display.scrollTimes)
+		if(display.scrollTimes && ++display.scrollCounter>DISPLAY_SCROLL_RATE)
 		{
-			int8_t l,p,p2;
-
-			display.scrollCounter++;
+			display.scrollCounter=0;
 
-			l=strlen(display.scrollText);
-			p=display.scrollPos;
-			p2=(display.scrollPos+1)%l;
+			++display.scrollPos;
+			if(display.scrollPos>=display.scrollLength)
+				display.scrollPos=0;
 
-			// this sets the ASCII characters of position and next position from the text to be displayed
-			localSevenSegs[0]=map_to_seg7(&sevenSeg_map,display.scrollText[p]);
-			localSevenSegs[1]=map_to_seg7(&sevenSeg_map,display.scrollText[p2]);
+			if(display.scrollPos==0 && display.scrollTimes>0)
+				--display.scrollTimes;
 
-			if (display.scrollCounter>DISPLAY_SCROLL_RATE)
-			{
-				display.scrollPos=p2;
-				display.scrollCounter=0;
-
-				if(p2==0 && display.scrollTimes>0)
-					--display.scrollTimes;
-			}
-		}
-		else
-		{
-			// if nothing to scroll, then continue to display current value or content
-			localSevenSegs[0]=display.sevenSegs[0];
-			localSevenSegs[1]=display.sevenSegs[1];
+			display.dirty=1;
 		}
+	}
 
-		// this is the way the P600 hardware (the LED matrix) is built:
-		// S&H in three waves,  8 bits in each wave are sent to
-		// 1) 8 button LEDs (all except tune)
-		// 2) the 7 segments of the left display digit + the dot
-		// 3) the 7 segments of the right display digit + the tune LED
-		// other parts of the display (other dots) are not connected
-		// 
-		// see also service manual board 1, LED matrix
-		
-
-		uint8_t b=0;
-
-		switch (display.activeCol)
-		{
-		case 0:	// all the LEDs as set in the bits of ledON (according to enum p600led_t) 
-				// note: this covers all "buttons" except Tune and the display dot (these are the 9th and 10th bit in .ledOn)  
-			b=display.ledOn; // set the bits 
-			if (display.blinkState) b^=display.ledBlinking; // deactivates the dot depending on blink state
-			break;
-		case 1: // left digit + the dot
-			b=localSevenSegs[0]&0x7f; // 7f is the mask that has the 7 elements (and only those) activated 
-			if (led_getOn(plDot)) b|=0x80; // activates the 8th bit (the display dot)
-			if (led_getBlinking(plDot) && display.blinkState) b^=0x80; // deactivates the dot depending on blink state
-			break;
-		case 2: // right digit + tune button LED
-			b=localSevenSegs[1]&0x7f; // 7f is the mask that has the 7 elements (and only those) activated 
-			if (led_getOn(plTune)) b|=0x80; // activates the 8th bit (the tune button LED)
-			if (led_getBlinking(plTune) && display.blinkState) b^=0x80; // deactivates the tune LED depending on blink state
-			break;
-		}
-		
-		display.activeRows[display.activeCol]=b;
+	if(display.dirty)
+	{
+		display.dirty=0;
+		render();
 	}
 	
+	// multiplex, one row per call
+	
 	BLOCK_INT
 	{
 		io_write(CSO1, 0x00); // switch all bits off at the address 9
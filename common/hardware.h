@@ -16,6 +16,11 @@ extern uint8_t io_read(uint8_t address);
 
 extern int8_t hardware_getNMIState(void);
 
+// RAM telemetry, the stack is painted at boot and its deepest use is scanned from the main loop
+extern uint16_t hardware_getStaticRAM(void); // .data + .bss
+extern uint16_t hardware_getStackUsage(void); // deepest so far
+extern uint16_t hardware_getRAMFree(void); // never touched since boot
+
 // Flat
 #define STORAGE_PAGE_SIZE 0x100UL 	//  256 bytes
 #define STORAGE_SIZE 0x10000UL 		//	64KB, 256 pages
@@ -26,5 +31,9 @@ extern int8_t hardware_getNMIState(void);
 extern void storage_write(uint32_t pageIdx, uint8_t *buf);
 extern void storage_read(uint32_t pageIdx, uint8_t *buf);
 
+// partial page access, size must not cross the end of storage
+extern void storage_writeBytes(uint16_t address, uint8_t *buf, uint16_t size);
+extern void storage_readBytes(uint16_t address, uint8_t *buf, uint16_t size);
+
 #endif	/* HARDWARE_H */
 
@@ -3,8 +3,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lfo.h"
-
-static uint16_t sineShape[256];
+#include "lfo_lookups.h"
+#include "rng.h"
 
 static void updateIncrement(struct lfo_s * lfo)
 {
@@ -15,7 +15,7 @@ static void updateSpeed(struct lfo_s * lfo)
 {
 	int32_t spd;
 	
-	spd=exponentialCourse(UINT16_MAX-lfo->speedCV,8000.0f,65535.0f);
+	spd=exponentialCourse(UINT16_MAX-lfo->speedCV,EXPONENTIAL_COURSE_RATE(8000.0),UINT16_MAX);
 
 	lfo->speed=spd<<4;
 }
@@ -33,7 +33,7 @@ static void handlePhaseOverflow(struct lfo_s * l)
 		l->rawOutput=l->halfPeriod*UINT16_MAX;
 		break;
 	case lsRand:
-		l->rawOutput=random();
+		l->rawOutput=rng_next();
 		break;
 	default:
 		;
@@ -71,10 +71,9 @@ void LOWERCODESIZE lfo_setShape(struct lfo_s * lfo, lfoShape_t shape)
 {
 	lfo->shape=shape;
 	
+	// the noise register only needs a start, it is never 0 afterwards
 	if(lfo->noise==0)
-		srandom(currentTick);
-	
-	lfo->noise=random();
+		lfo->noise=rng_next();
 }
 
 void LOWERCODESIZE lfo_resetPhase(struct lfo_s * lfo)
@@ -111,12 +110,7 @@ const char * lfo_shapeName(lfoShape_t shape)
 
 void lfo_init(struct lfo_s * lfo)
 {
-	int16_t i;
-	
 	memset(lfo,0,sizeof(struct lfo_s));
-	
-	for(i=0;i<256;++i)
-		sineShape[i]=(cosf((i/255.0f+1.0f)*M_PI)+1.0f)/2.0f*65535.0f;
 }
 
 inline void lfo_update(struct lfo_s * l)
@@ -134,7 +128,7 @@ inline void lfo_update(struct lfo_s * l)
 		l->rawOutput=l->phase>>8;
 		break;
 	case lsSine:
-		l->rawOutput=computeShape(l->phase,sineShape,1);
+		l->rawOutput=computeShape_P(l->phase,sineShape,1);
 		break;
 	case lsNoise:
 		l->noise=lfsr(l->noise,(l->speedCV>>12)+1);
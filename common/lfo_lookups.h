@@ -0,0 +1,34 @@
+// generated by firmware/gen_lookups.py, do not edit
+
+#ifndef LFO_LOOKUPS_H
+#define LFO_LOOKUPS_H
+
+#include "synth.h"
+
+const PROGMEM uint16_t sineShape[]=
+{
+	0,2,9,22,39,62,89,121,159,201,248,300,
+	357,419,486,557,634,716,802,893,989,1090,1196,1306,
+	1421,1541,1666,1796,1930,2069,2212,2360,2513,2670,2832,2999,
+	3170,3345,3525,3710,3898,4092,4289,4491,4697,4908,5122,5341,
+	5564,5791,6022,6258,6497,6740,6987,7238,7493,7752,8015,8281,
+	8552,8825,9103,9384,9668,9956,10248,10543,10841,11143,11448,11756,
+	12067,12382,12700,13020,13344,13670,14000,14332,14667,15005,15346,15689,
+	16035,16383,16734,17087,17443,17801,18161,18524,18888,19255,19624,19995,
+	20367,20742,21118,21497,21877,22258,22641,23026,23412,23800,24189,24579,
+	24970,25363,25757,26152,26548,26945,27342,27741,28140,28540,28941,29342,
+	29744,30146,30548,30951,31355,31758,32161,32565,32969,33373,33776,34179,
+	34583,34986,35388,35790,36192,36593,36994,37394,37793,38192,38589,38986,
+	39382,39777,40171,40564,40955,41345,41734,42122,42508,42893,43276,43657,
+	44037,44416,44792,45167,45539,45910,46279,46646,47010,47373,47733,48091,
+	48447,48800,49151,49499,49845,50188,50529,50867,51202,51534,51864,52190,
+	52514,52834,53152,53467,53778,54086,54391,54693,54991,55286,55578,55866,
+	56150,56431,56709,56982,57253,57519,57782,58041,58296,58547,58794,59037,
+	59276,59512,59743,59970,60193,60412,60626,60837,61043,61245,61442,61636,
+	61824,62009,62189,62364,62535,62702,62864,63021,63174,63322,63465,63604,
+	63738,63868,63993,64113,64228,64338,64444,64545,64641,64732,64818,64900,
+	64977,65048,65115,65177,65234,65286,65333,65375,65413,65445,65472,65495,
+	65512,65525,65532,65535,
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include "uart_6850.h"
 #include "import.h"
 #include "arp.h"
+#include "clock.h"
 
 #include "../xnormidi/midi_device.h"
 #include "../xnormidi/midi.h"
@@ -24,6 +25,14 @@ static MidiDevice midi;
 static int16_t sysexSize;
 static byteQueue_t sendQueue;
 static uint8_t sendQueueData[32];
+static byteQueue_t realtimeQueue; // clock, start, stop..., sent ahead of sendQueue
+
+// bend and modwheel are applied once per midi_update(), the last value wins
+static int16_t pendingBend;
+static uint16_t pendingModulation;
+static uint8_t pendingWheelMask;
+static uint8_t realtimeQueueData[8];
+static volatile uint8_t inputCount; // see midi_getInputCount()
 
 extern void refreshFullState(void);
 extern void refreshPresetMode(void);
@@ -108,7 +117,7 @@ typedef struct {
 	uint8_t semitone_fraction_two;
 } semitone_t;
 
-static void mtsReceiveBulkTuningDump(uint8_t * buf, int16_t size) // imogen: this function is not used anf there is no clear use case for it - maybe it should be removed
+static NOINLINE void mtsReceiveBulkTuningDump(uint8_t * buf, int16_t size) // imogen: this function is not used anf there is no clear use case for it - maybe it should be removed
 {
 	if (size!=402) {
 #ifdef DEBUG
@@ -149,6 +158,31 @@ static void mtsReceiveBulkTuningDump(uint8_t * buf, int16_t size) // imogen: thi
 
 }
 
+static void sendDiagnostics(void)
+{
+	uint16_t v;
+
+	// version, then 16 bit little endian values
+	tempBuffer[0]=2;
+	v=hardware_getStaticRAM();
+	tempBuffer[1]=v;
+	tempBuffer[2]=v>>8;
+	v=hardware_getStackUsage();
+	tempBuffer[3]=v;
+	tempBuffer[4]=v>>8;
+	v=hardware_getRAMFree();
+	tempBuffer[5]=v;
+	tempBuffer[6]=v>>8;
+	v=synth_getOverrunCount(); // since version 2
+	tempBuffer[7]=v;
+	tempBuffer[8]=v>>8;
+	v=synth_getMissedTickCount();
+	tempBuffer[9]=v;
+	tempBuffer[10]=v>>8;
+
+	sysexSend(SYSEX_COMMAND_DIAGNOSTICS,11);
+}
+
 static void sysexReceiveByte(uint8_t b)
 {
 	int16_t size;
@@ -180,6 +214,9 @@ static void sysexReceiveByte(uint8_t b)
 			case SYSEX_COMMAND_PATCH_DUMP_REQUEST:
 				midi_dumpPreset(tempBuffer[4]);
 				break;
+			case SYSEX_COMMAND_DIAGNOSTICS_REQUEST:
+				sendDiagnostics();
+				break;
 			}
 		}
 		else if(tempBuffer[0]==SYSEX_ID_UNIVERSAL_NON_REALTIME) // imogen: if SysEx tuning data usage is removed (see above), this part will be obsolete as well  
@@ -275,7 +312,8 @@ static void midi_ccEvent(MidiDevice * device, uint8_t channel, uint8_t control,
 	}
 	else if(control==1) // modwheel
 	{
-		synth_wheelEvent(0,value<<9,2,0,0);
+		pendingModulation=value<<9;
+		pendingWheelMask|=2;
 	}
 	else if(control==7) // added midi volume
     {
@@ -431,7 +469,8 @@ static void midi_pitchBendEvent(MidiDevice * device, uint8_t channel, uint8_t v1
 	value-=0x2000;
 	value<<=2;
 	
-	synth_wheelEvent(value,0,1,0,0);
+	pendingBend=value;
+	pendingWheelMask|=1;
 }
 
 static void midi_sysexEvent(MidiDevice * device, uint16_t count, uint8_t b0, uint8_t b1, uint8_t b2)
@@ -482,14 +521,24 @@ void midi_init(void)
 	sysexSize=0;
 	
 	bytequeue_init(&sendQueue, sendQueueData, sizeof(sendQueueData));
+	bytequeue_init(&realtimeQueue, realtimeQueueData, sizeof(realtimeQueueData));
 }
 
 void midi_update(int8_t onlySend)
 {
 	if(!onlySend)
+	{
 		midi_device_process(&midi);
+
+		if(pendingWheelMask)
+		{
+			synth_wheelEvent(pendingBend,pendingModulation,pendingWheelMask,0,0);
+			pendingWheelMask=0;
+		}
+	}
 	
-	if(bytequeue_length(&sendQueue)>0)
+	// realtime bytes go first, regular ones wait for the transmitter to be free
+	if(bytequeue_length(&sendQueue)>0 && !bytequeue_length(&realtimeQueue))
 	{
 		uint8_t b;
 		b=bytequeue_get(&sendQueue,0);
@@ -498,11 +547,42 @@ void midi_update(int8_t onlySend)
 	}
 }
 
+void midi_sendRealtime(uint8_t b)
+{
+	// never wait, this is called from the interrupt, dropped if the queue is full
+	bytequeue_enqueue(&realtimeQueue,b);
+}
+
+void midi_updateRealtime(void)
+{
+	uint8_t b;
+
+	// realtime messages can be sent between the bytes of any other message
+	if(!bytequeue_length(&realtimeQueue))
+		return;
+
+	b=bytequeue_get(&realtimeQueue,0);
+	if(!uart_trySend(b))
+		return;
+	bytequeue_remove(&realtimeQueue,1);
+
+	if(b==MIDI_CLOCK)
+		clock_midiClockSent();
+}
+
 void midi_newData(uint8_t data)
 {
+	if(data<MIDI_CLOCK)
+		++inputCount;
+	
 	midi_device_input(&midi,1,&data);
 }
 
+uint8_t midi_getInputCount(void)
+{
+	return inputCount;
+}
+
 uint8_t midi_dumpPreset(int8_t number)
 {
 	int16_t size=0;
@@ -6,6 +6,9 @@
 void midi_init(void);
 void midi_update(int8_t onlySend);
 void midi_newData(uint8_t data);
+uint8_t midi_getInputCount(void); // received bytes but realtime ones, wraps, changes as soon as a byte comes from the interrupt
+void midi_sendRealtime(uint8_t b);
+void midi_updateRealtime(void); // on every 2khz tick
 uint8_t midi_dumpPreset(int8_t number);
 void midi_dumpPresets(void);
 void midi_sendNoteEvent(uint8_t note, int8_t gate, uint16_t velocity);
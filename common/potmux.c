@@ -225,7 +225,7 @@ int8_t potmux_isPotZeroCentered(p600Pot_t pot, uint8_t layout)
 	return pot==ppFilEnvAmt || pot==ppPModFilEnv || pot==ppFreqBFine || pot==ppMTune || pot==ppPitchWheel || (pot==ppMixer && layout==1);
 }
 
-inline void potmux_update(uint8_t updateAll)
+inline void potmux_update(uint8_t updateAll, uint8_t excitedOnly)
 {
 	int16_t i;
 
@@ -233,12 +233,12 @@ inline void potmux_update(uint8_t updateAll)
     {
         if (response[i]!=0)
         {
-            if (potmux.potcounter[i]==0 || potmux.potExcited[i] || updateAll)
+            if ((potmux.potcounter[i]==0 && !excitedOnly) || potmux.potExcited[i] || updateAll)
             {
                 updatePot(i);
             }
+            potmux.potcounter[i]=(potmux.potcounter[i]+1)%(2*response[i]);
         }
-        potmux.potcounter[i]=(potmux.potcounter[i]+1)%(2*response[i]);
     }
 }
 
@@ -0,0 +1,77 @@
+// generated by syxmgmt/gen_preset_layout.py from syxmgmt/preset.spec, do not edit
+
+#ifndef PRESET_LAYOUT_H
+#define PRESET_LAYOUT_H
+
+#define PRESET_LAYOUT_VERSION 8
+#define PRESET_FIELD_COUNT 64
+
+static const struct presetField_s presetLayout[PRESET_FIELD_COUNT] PROGMEM =
+{
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFreqA]),0}, // Frequency A
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpVolA]),0}, // Volume A
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpAPW]),0}, // PWA
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFreqB]),0}, // Frequency B
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpVolB]),0}, // Volume B
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpBPW]),0}, // PWB
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFreqBFine]),0}, // Frequency Fine B
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpCutoff]),0}, // Cutoff
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpResonance]),0}, // Resonance
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFilEnvAmt]),0}, // Filter Envelope Amount
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFilRel]),0}, // Filter Release
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFilSus]),0}, // Filter Sustain
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFilDec]),0}, // Filter Decay
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFilAtt]),0}, // Filter Attack
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpAmpRel]),0}, // 2nd Release
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpAmpSus]),0}, // 2nd Sustain
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpAmpDec]),0}, // 2nd Decay
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpAmpAtt]),0}, // 2nd Attack
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpPModFilEnv]),0}, // Poly Mod Envelope Amount
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpPModOscB]),0}, // Poly Mod OSC B
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpLFOFreq]),0}, // LFO Frequency
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpLFOAmt]),0}, // LFO Amount
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpGlide]),0}, // Glide
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpAmpVelocity]),0}, // Amp Velocity
+	{1,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpFilVelocity]),0}, // Filter Velocity
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spASaw]),0}, // Saw A
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spATri]),0}, // Tri A
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spASqr]),0}, // SQR A
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spBSaw]),0}, // Saw B
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spBTri]),0}, // Tri B
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spBSqr]),0}, // SQR B
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spSync]),0}, // Sync
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spPModFA]),0}, // Poly Mod Frequency A
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spPModFil]),0}, // Poly Mod Filter
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spLFOShape]),0}, // LFO Shape
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spLegacyLFORange]),0}, // (unused, LFO range slot)
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spLFOTargets]),0}, // LFO Targets
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spTrackingShift]),0}, // Tracking Shift
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spFilEnvShape]),0}, // Filter Envelope Shape
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spFilEnvSlow]),0}, // Filter Envelope Speed
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spAmpEnvShape]),0}, // Amp Envelope Shape
+	{1,0,1,offsetof(struct preset_s,steppedParameters[holdPedal]),0}, // Amp Envelope Speed
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spUnison]),0}, // Unison
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spAssignerPriority]),0}, // Assigner Priority
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spBenderSemitones]),0}, // Bender Semitones
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spBenderTarget]),0}, // Bender Target
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spModWheelRange]),0}, // Modulation Wheel Range
+	{1,0,1,offsetof(struct preset_s,steppedParameters[spChromaticPitch]),0}, // Chromatic Pitch
+	{2,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpModDelay]),0}, // Modulation Delay
+	{2,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpVibFreq]),0}, // Vibrato Frequency
+	{2,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpVibAmt]),0}, // Vibrato Amount
+	{2,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpUnisonDetune]),0}, // Unison Detune
+	{2,PF_WORD|PF_UNUSED,1,0,0}, // (unused, arp/seq clock slot)
+	{2,0,1,offsetof(struct preset_s,steppedParameters[spModwheelTarget]),0}, // Modulation Wheel Target
+	{2,0,1,offsetof(struct preset_s,steppedParameters[spVibTarget]),0}, // Vibrato Target
+	{2,0,6,offsetof(struct preset_s,voicePattern),0}, // Voice Pattern (6 voices)
+	{7,PF_WORD,12,offsetof(struct preset_s,perNoteTuning),0}, // Tuning per Note (12 notes)
+	{8,PF_MAX,1,offsetof(struct preset_s,steppedParameters[spPWMBug]),1}, // PW Bug
+	{8,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpSpread]),0}, // Vintage
+	{8,PF_WORD,1,offsetof(struct preset_s,continuousParameters[cpExternal]),0}, // Ext Voltage
+	{8,PF_MAX,1,offsetof(struct preset_s,steppedParameters[spEnvRouting]),3}, // Envelope Routing
+	{8,PF_MAX,1,offsetof(struct preset_s,steppedParameters[spAssign]),1}, // Voice Assigner
+	{8,PF_MAX,1,offsetof(struct preset_s,steppedParameters[spLFOSync]),7}, // LFO Sync
+	{8,0,16,offsetof(struct preset_s,patchName),0}, // Patch Name
+};
+
+#endif
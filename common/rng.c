@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////////////////
+// Pseudo random numbers, xorshift32 instead of avr-libc random(), which does a
+// 32 bit division per number
+////////////////////////////////////////////////////////////////////////////////
+
+#include "rng.h"
+
+static uint32_t rngState=2463534242UL; // must not be 0
+
+inline uint32_t rng_next(void)
+{
+	uint32_t x=rngState;
+
+	// the (8,9,23) triple has a full period and mostly shifts whole bytes
+	x^=x<<8;
+	x^=x>>9;
+	x^=(uint32_t)(uint16_t)((uint16_t)x<<7)<<16; // x<<23
+
+	rngState=x;
+	return x;
+}
+
+uint8_t rng_below(uint8_t n)
+{
+	// scaled by a multiply, no division
+	return ((uint16_t)(uint8_t)rng_next()*n)>>8;
+}
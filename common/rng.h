@@ -0,0 +1,11 @@
+#ifndef RNG_H
+#define	RNG_H
+
+#include <stdint.h>
+
+// pseudo random numbers, shared by the LFOs and the arpeggiator
+
+uint32_t rng_next(void); // never 0
+uint8_t rng_below(uint8_t n); // 0..n-1, n=0 gives 0
+
+#endif	/* RNG_H */
@@ -8,9 +8,14 @@
 #define SCANNER_KEYS_START 64
 #define SCANNER_DEBOUNCE_TIMEOUT 5
 
+#if SCANNER_DEBOUNCE_TIMEOUT>7
+#error "debounce timeouts are 3 bits"
+#endif
+
 static struct
 {
-	uint8_t state[SCANNER_BYTES*8];
+	uint8_t state[SCANNER_BYTES]; // one bit per key
+	uint8_t timeout[3][SCANNER_BYTES]; // debounce timeouts, bit sliced: bit n of each key's timeout in timeout[n]
 } scanner;
 
 void scanner_init(void)
@@ -20,7 +25,7 @@ void scanner_init(void)
 
 static FORCEINLINE int scanner_state(uint8_t key)
 {
-	return scanner.state[key]&1;
+	return (scanner.state[key>>3]>>(key&7))&1;
 }
 
 FORCEINLINE int8_t scanner_keyState(uint8_t key)
@@ -45,13 +50,13 @@ int8_t scanner_isKeyDown(uint8_t note)
 {
 	if (note<SCANNER_BASE_NOTE || note>SCANNER_C5)
 		return 0;
-	return scanner.state[note-SCANNER_BASE_NOTE+SCANNER_KEYS_START]&1;
+	return scanner_state(note-SCANNER_BASE_NOTE+SCANNER_KEYS_START);
 }
 
 void scanner_update(int8_t fullScan)
 {
-	uint8_t i,j,stateIdx;
-	uint8_t ps,flag,curState;		
+	uint8_t i,j;
+	uint8_t ps,pending,changed,borrow,t;
 
 	for(i=fullScan?0:(SCANNER_KEYS_START/8);i<SCANNER_BYTES;++i)
 	{
@@ -64,27 +69,37 @@ void scanner_update(int8_t fullScan)
 			ps=io_read(CSO2);
 		}
 
-		for(j=0;j<8;++j)
+		// a whole row at once: keys in debounce count their timeout down, others take state changes
+
+		pending=scanner.timeout[0][i]|scanner.timeout[1][i]|scanner.timeout[2][i];
+
+		borrow=pending;
+		for(j=0;j<3;++j)
 		{
-			stateIdx=i*8+j;
-			flag=ps&1;
-			curState=scanner.state[stateIdx];
+			t=scanner.timeout[j][i];
+			scanner.timeout[j][i]=t^borrow;
+			borrow&=~t;
+		}
 
-			// debounce timeouts
-			if(curState&0xfe)
-			{
-				scanner.state[stateIdx]=curState-2;
-			}
-			else if(flag ^ (curState&1)) // if state change and not in debounce
+		changed=(ps^scanner.state[i])&~pending;
+
+		if(!changed)
+			continue;
+
+		// start debounce timeouts
+		for(j=0;j<3;++j)
+			if(SCANNER_DEBOUNCE_TIMEOUT&(1<<j))
+				scanner.timeout[j][i]|=changed;
+			else
+				scanner.timeout[j][i]&=~changed;
+
+		// update state & do events, in key order
+		for(j=0;changed;++j,changed>>=1)
+			if(changed&1)
 			{
-				// update state & start debounce timeout
-				scanner.state[stateIdx]=flag|(SCANNER_DEBOUNCE_TIMEOUT<<1);
-				// do event
-				scanner_event(stateIdx,flag);
+				scanner.state[i]^=1<<j;
+				scanner_event(i*8+j,(ps>>j)&1);
 			}
-
-			ps>>=1;
-		}
 	}
 }
 	
@@ -11,15 +11,24 @@
 #include "clock.h"
 #include "arp.h"
 
+#define SEQ_NO_BLOCK UINT16_MAX
+
 struct track
 {
 	seqMode_t mode;
-	uint8_t events[SEQ_NOTE_MEMORY];
-	uint8_t eventCount;
-	int16_t eventIndex;
-	int16_t prevEventIndex;
-	uint8_t stepCount;
-	int8_t previousTranspose;
+	uint16_t eventCount;
+	uint16_t eventIndex;
+	uint16_t stepCount;
+
+	// the events window: the block at eventIndex and the one after it, prefetched
+	uint8_t blocks[2][SEQ_BLOCK_SIZE];
+	uint16_t blockNumbers[2];
+	int8_t curBlock;
+	int8_t prefetch;
+
+	// notes of the step that is playing (transposed) or being recorded
+	uint8_t chord[SEQ_CHORD_MAX];
+	uint8_t chordCount;
 };
 
 static struct
@@ -43,22 +52,103 @@ static int8_t anyTrackPlaying(void)
 	return 0;
 }
 
-static void finishPreviousNotes(struct track *tp)
-{	
-	uint8_t s,n;
+static FORCEINLINE int8_t trackNumber(struct track *tp)
+{
+	return tp-seq.tracks;
+}
+
+static void invalidateBlocks(struct track *tp)
+{
+	tp->blockNumbers[0]=tp->blockNumbers[1]=SEQ_NO_BLOCK;
+	tp->prefetch=0;
+}
 
-	if(!tp->eventCount||tp->prevEventIndex<0) // return if no events or no previous event
+static void loadBlock(struct track *tp, int8_t slot, uint16_t block)
+{
+	storage_readSequencerEvents(trackNumber(tp),block*SEQ_BLOCK_SIZE,tp->blocks[slot],SEQ_BLOCK_SIZE);
+	tp->blockNumbers[slot]=block;
+}
+
+// makes block current, the other slot keeps the previous one
+static void selectBlock(struct track *tp, uint16_t block, int8_t load)
+{
+	int8_t other=tp->curBlock^1;
+
+	if(tp->blockNumbers[tp->curBlock]==block)
 		return;
 
-	s=tp->events[tp->prevEventIndex];
-	do {
-		s&=SEQ_NOTEBITS;
+	if(tp->blockNumbers[other]!=block)
+	{
+		if(load)
+			loadBlock(tp,other,block);
+		else
+		{
+			memset(tp->blocks[other],ASSIGNER_NO_NOTE,SEQ_BLOCK_SIZE);
+			tp->blockNumbers[other]=block;
+		}
+	}
+
+	tp->curBlock=other;
+	tp->prefetch=1;
+}
+
+static uint8_t getEvent(struct track *tp, uint16_t index)
+{
+	selectBlock(tp,index/SEQ_BLOCK_SIZE,1);
+	return tp->blocks[tp->curBlock][index%SEQ_BLOCK_SIZE];
+}
+
+// loads the block that will be needed next, away from the step timing
+static void prefetchBlock(struct track *tp)
+{
+	uint16_t block;
+	int8_t other=tp->curBlock^1;
+
+	if(!tp->prefetch)
+		return;
+
+	tp->prefetch=0;
+
+	block=tp->blockNumbers[tp->curBlock]+1;
+	if(block*SEQ_BLOCK_SIZE>=tp->eventCount)
+		block=0;
+
+	if(tp->blockNumbers[tp->curBlock]!=block && tp->blockNumbers[other]!=block)
+		loadBlock(tp,other,block);
+}
+
+static void appendEvent(struct track *tp, uint8_t s)
+{
+	uint16_t i=tp->eventCount;
+
+	selectBlock(tp,i/SEQ_BLOCK_SIZE,i%SEQ_BLOCK_SIZE); // a new block doesn't need loading
+	tp->blocks[tp->curBlock][i%SEQ_BLOCK_SIZE]=s;
+
+	// store blocks as soon as they are full
+	if(++tp->eventCount%SEQ_BLOCK_SIZE==0)
+		storage_writeSequencerEvents(trackNumber(tp),i+1-SEQ_BLOCK_SIZE,tp->blocks[tp->curBlock],SEQ_BLOCK_SIZE);
+}
+
+static void storeTrack(struct track *tp)
+{
+	uint16_t block=tp->eventCount/SEQ_BLOCK_SIZE;
+	int8_t slot;
+
+	// last, incomplete block
+	for(slot=0;slot<2;++slot)
+		if(tp->blockNumbers[slot]==block && tp->eventCount%SEQ_BLOCK_SIZE)
+			storage_writeSequencerEvents(trackNumber(tp),block*SEQ_BLOCK_SIZE,tp->blocks[slot],tp->eventCount%SEQ_BLOCK_SIZE);
+
+	storage_saveSequencer(trackNumber(tp),tp->eventCount,tp->stepCount);
+}
 
-		if(s==SEQ_REST||s==SEQ_TIE)
-			break;
+static void finishPreviousNotes(struct track *tp)
+{	
+	uint8_t i,n;
 
-		// handle notes
-		n=s+SCANNER_BASE_NOTE+tp->previousTranspose;
+	for(i=0;i<tp->chordCount;++i)
+	{
+		n=tp->chord[i];
 
 		// send note to assigner, velocity at half (MIDI value 64)
 		// is it ok to always send that, even in local off mode  what's the side effect?
@@ -66,10 +156,9 @@ static void finishPreviousNotes(struct track *tp)
 
 		// pass to MIDI out but not in local off mode
 		if (settings.midiMode==0) midi_sendNoteEvent(n,0,0);
+	}
 
-		tp->prevEventIndex=(tp->prevEventIndex+1)%tp->eventCount;
-		s=tp->events[tp->prevEventIndex];
-	} while(s&SEQ_CONT);
+	tp->chordCount=0;
 }
 
 static FORCEINLINE void playStep(int8_t track)
@@ -87,21 +176,16 @@ static FORCEINLINE void playStep(int8_t track)
 	if(!tp->eventCount)
 		return;
 
-	s=tp->events[tp->eventIndex];
+	s=getEvent(tp,tp->eventIndex);
 	if(s!=SEQ_TIE) // terminate previous unless it's a tie
 		finishPreviousNotes(tp);
-	if(s!=SEQ_REST&&s!=SEQ_TIE) // a note
-	{
-		// save note index so we can do note off later
-		tp->prevEventIndex=tp->eventIndex;
-		tp->previousTranspose=seq.transpose;
-	}
 	do {
 		s&=SEQ_NOTEBITS;
-		if(s!=SEQ_REST&&s!=SEQ_TIE) // a note
+		if(s!=SEQ_REST&&s!=SEQ_TIE&&tp->chordCount<SEQ_CHORD_MAX) // a note
 		{	
-			// handle notes
+			// handle notes, save them so we can do note off later
 			n=s+SCANNER_BASE_NOTE+seq.transpose;
+			tp->chord[tp->chordCount++]=n;
 
 			// send note to assigner, velocity at half (MIDI value 64)
             assigner_assignNote(n,1,HALF_RANGE,0);
@@ -111,7 +195,7 @@ static FORCEINLINE void playStep(int8_t track)
 
 		}
 		tp->eventIndex=(tp->eventIndex+1)%tp->eventCount; // this cycles through the number of events by mod(counter)
-		s=tp->events[tp->eventIndex];
+		s=getEvent(tp,tp->eventIndex);
 	} while(s&SEQ_CONT); // all notes with this bit set are part of the same "chord", e.g. which ae the continuation flag set 
 }
 
@@ -129,27 +213,19 @@ inline void seq_setMode(int8_t track, seqMode_t mode)
 
 	if(oldMode==smOff)
 	{
-		// load sequence from storage on start
-		if(!storage_loadSequencer(track,tp->events,SEQ_NOTE_MEMORY))
-			memset(tp->events,ASSIGNER_NO_NOTE,SEQ_NOTE_MEMORY);
-
-		// compute note and step count
-		tp->eventCount=0;
-		tp->stepCount=0;
-		while(tp->eventCount<SEQ_NOTE_MEMORY)
+		// get sequence length from storage on start, events are read as needed
+		if(!storage_loadSequencer(track,&tp->eventCount,&tp->stepCount))
 		{
-			uint8_t s=tp->events[tp->eventCount];
-			if(!(s&SEQ_CONT))
-				tp->stepCount++;
-			if(s==ASSIGNER_NO_NOTE)
-				break;
-			tp->eventCount++;
+			tp->eventCount=0;
+			tp->stepCount=0;
 		}
+		invalidateBlocks(tp);
 	}
 	else if(oldMode==smRecording)
 	{
 		// store sequence to storage on record end
-		storage_saveSequencer(track,tp->events,SEQ_NOTE_MEMORY);
+		storeTrack(tp);
+		tp->chordCount=0;
 	}
 	else if(oldMode==smPlaying)
 	{
@@ -166,20 +242,19 @@ inline void seq_setMode(int8_t track, seqMode_t mode)
 
 	// We need to put this after setting tp->mode to play, or playStep 
 	// won't play anything.
-	// The /2 bit is to determine if the second sequence has been
+	// The half phase bit is to determine if the second sequence has been
 	// started just before or just after a step has been played of
-	// the first. If seq.counter is closer to 0 than to seq.speed,
+	// the first. If the clock phase is closer to 0 than to a full step,
 	// then the second sequence was started just after the first had
 	// played its step, so we play the first step of the second sequence
 	// as fast as we can so it is heard (almost) simultaneously with
-	// the step of the first sequence. Conversely, if seq.counter is closer
-	// to seq.speed, the second sequence was started slightly before
+	// the step of the first sequence. Conversely, if the clock phase is closer
+	// to a full step, the second sequence was started slightly before
 	// the first had played its step (this only happens when the second
 	// sequence is started after the first has already played (at least)
 	// one step), so we don't play the step here, but let it be played
 	// as usual from seq_update().
-	uint16_t speed=clock_getSpeed();
-	if(mode==smPlaying&&alreadyPlaying&&speed!=UINT16_MAX&&clock_getCounter()<speed/2)
+	if(mode==smPlaying&&alreadyPlaying&&clock_getSpeed()!=UINT16_MAX&&clock_getPhase()<UINT32_MAX/2)
 		playStep(track);
 }
 
@@ -198,7 +273,6 @@ FORCEINLINE void seq_resetCounter(int8_t track, int8_t beatReset)
 {
 	seq_silence(track);
 	seq.tracks[track].eventIndex=0; // reinit
-	seq.tracks[track].prevEventIndex=-1;
 	if (!anyTrackPlaying()&&arp_getMode()==amOff) // it's a fresh start
 	{ 
 		synth_resetClockBar(); // reset the LFO sync counter
@@ -212,14 +286,14 @@ FORCEINLINE seqMode_t seq_getMode(int8_t track)
 	return seq.tracks[track].mode;
 }
 
-FORCEINLINE uint8_t seq_getStepCount(int8_t track)
+FORCEINLINE uint16_t seq_getStepCount(int8_t track)
 {
 	return seq.tracks[track].stepCount;
 }
 
 FORCEINLINE int8_t seq_full(int8_t track)
 {
-	return seq.tracks[track].eventCount+seq.addTies>=SEQ_NOTE_MEMORY;
+	return seq.tracks[track].eventCount+seq.addTies>=SEQ_EVENT_MEMORY;
 }
 
 static FORCEINLINE void noteOnCount(void)
@@ -237,7 +311,7 @@ static int8_t spaceAvail(struct track *tp)
 {
   // We need to have space not only for notes but also for any added
   // tie events.
-  return tp->eventCount+seq.addTies<SEQ_NOTE_MEMORY;
+  return tp->eventCount+seq.addTies<SEQ_EVENT_MEMORY;
 }
 
 static FORCEINLINE void inputNote(struct track *tp, uint8_t note, uint8_t pressed)
@@ -250,7 +324,7 @@ static FORCEINLINE void inputNote(struct track *tp, uint8_t note, uint8_t presse
 		tp->eventCount=0;
 		tp->stepCount=0;
 		seq.addTies=0;
-		memset(tp->events,ASSIGNER_NO_NOTE,SEQ_NOTE_MEMORY);
+		invalidateBlocks(tp);
 		return;
 	}
 
@@ -267,8 +341,7 @@ static FORCEINLINE void inputNote(struct track *tp, uint8_t note, uint8_t presse
 		// erase all events which belong to the same SEQ_CONT block back to previous one
 		while(tp->eventCount)
 		{
-			uint8_t s=tp->events[--tp->eventCount];
-			tp->events[tp->eventCount]=ASSIGNER_NO_NOTE;
+			uint8_t s=getEvent(tp,--tp->eventCount);
 			if(!(s&SEQ_CONT))
 				break;
 		}
@@ -283,10 +356,7 @@ static FORCEINLINE void inputNote(struct track *tp, uint8_t note, uint8_t presse
 			return;
 		tp->stepCount++;
 		if (!seq.noteOns) // no notes down => add rest
-		{
-			tp->events[tp->eventCount]=SEQ_REST;
-			tp->eventCount++;
-		}
+			appendEvent(tp,SEQ_REST);
 		else // just count tie events to be added later
 			seq.addTies++;
 		return;
@@ -302,19 +372,21 @@ static FORCEINLINE void inputNote(struct track *tp, uint8_t note, uint8_t presse
 		note-=SCANNER_BASE_NOTE;
 		// Advance step count when we hit first note of a chord.
 		if (first)
+		{
 			tp->stepCount++;
+			tp->chordCount=0;
+		}
 		else
 		{
 			// check for duplicates
-			int8_t searchIndex=tp->eventCount-1;
-			uint8_t event;
-			do {
-				event=tp->events[searchIndex];
-				if((event&SEQ_NOTEBITS)==note)
+			for(uint8_t i=0;i<tp->chordCount;++i)
+				if(tp->chord[i]==note)
 					return; // duplicate, so don't use
-			} while((event&SEQ_CONT)&&--searchIndex>=0);
+			if(tp->chordCount>=SEQ_CHORD_MAX)
+				return;
 		}
-		tp->events[tp->eventCount++]=note|(first?0:SEQ_CONT);
+		tp->chord[tp->chordCount++]=note;
+		appendEvent(tp,note|(first?0:SEQ_CONT));
 	}
 	else
 	{
@@ -326,9 +398,11 @@ static FORCEINLINE void inputNote(struct track *tp, uint8_t note, uint8_t presse
 		// put down additional tie events
 		// We know there's space for these, as spaceAvail()
 		// during note entry takes it into account
-		memset(&tp->events[tp->eventCount],SEQ_TIE,seq.addTies);
-		tp->eventCount+=seq.addTies;
-		seq.addTies=0;
+		while(seq.addTies)
+		{
+			appendEvent(tp,SEQ_TIE);
+			seq.addTies--;
+		}
 	}
 }
 
@@ -340,8 +414,14 @@ void seq_inputNote(uint8_t note, uint8_t pressed)
 
 void seq_update(void)
 {
-	for(int8_t track=0;track<SEQ_TRACK_COUNT;++track)
+	int8_t track;
+
+	for(track=0;track<SEQ_TRACK_COUNT;++track)
 		playStep(track);
+
+	for(track=0;track<SEQ_TRACK_COUNT;++track)
+		if(seq.tracks[track].mode==smPlaying)
+			prefetchBlock(&seq.tracks[track]);
 }
 
 void seq_init(void)
@@ -351,8 +431,5 @@ void seq_init(void)
 	memset(&seq,0,sizeof(seq));
 
 	for(track=0;track<SEQ_TRACK_COUNT;++track)
-	{
-		seq.tracks[track].eventIndex=0;
-		memset(seq.tracks[track].events,ASSIGNER_NO_NOTE,SEQ_NOTE_MEMORY);
-	}		
+		invalidateBlocks(&seq.tracks[track]);
 }
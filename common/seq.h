@@ -19,8 +19,9 @@
 #define SEQ_TIE (SEQ_REST-1)
 
 // sequencer config
-#define SEQ_NOTE_MEMORY 128
 #define SEQ_TRACK_COUNT 2
+#define SEQ_BLOCK_SIZE 32 // events are streamed from storage by blocks, see SEQ_EVENT_MEMORY for the track size
+#define SEQ_CHORD_MAX 16 // notes per step
 
 // Codes from keypad presses
 #define SEQ_NOTE_STEP UINT8_MAX-1
@@ -40,7 +41,7 @@ void seq_setMode(int8_t track, seqMode_t mode);
 void seq_setSpeed(uint16_t speed);
 void seq_setTranspose(int8_t transpose);
 seqMode_t seq_getMode(int8_t track);
-uint8_t seq_getStepCount(int8_t track);
+uint16_t seq_getStepCount(int8_t track);
 int8_t seq_full(int8_t track);
 void seq_resetCounter(int8_t track, int8_t beatReset);
 void seq_silence(int8_t track);
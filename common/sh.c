@@ -10,8 +10,10 @@
 static struct
 {
 	uint32_t immediateBits;
+	uint32_t lockedCVs;
 	uint16_t cvs[SH_CV_COUNT];
 	uint8_t gateBits;
+	uint8_t lockedGates;
 } sh;
 
 static inline void updateGates(void)
@@ -57,6 +59,9 @@ static inline void updateCV(p600CV_t cv, uint16_t cvv)
 
 inline void sh_setCV(p600CV_t cv,uint16_t value, uint8_t flags)
 {
+	if(sh.lockedCVs&((uint32_t)1<<cv))
+		return;
+	
 	if(flags&SH_FLAG_IMMEDIATE)
 	{
 		updateCV(cv,value);
@@ -120,12 +125,24 @@ inline void sh_setGate(p600Gate_t gate,int8_t on)
 {
 	uint8_t mask=1<<gate;
 	
+	if(sh.lockedGates&mask)
+		return;
+	
 	sh.gateBits&=~mask;
 	if (on) sh.gateBits|=mask;
 	
 	updateGates();
 }
 
+void sh_lock(uint32_t cvMask, uint8_t gateMask)
+{
+	BLOCK_INT
+	{
+		sh.lockedCVs=cvMask;
+		sh.lockedGates=gateMask;
+	}
+}
+
 void sh_init()
 {
 	memset(&sh,0,sizeof(sh));
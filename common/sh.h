@@ -14,6 +14,9 @@ void sh_setCV32Sat_FastPath(p600CV_t cv,int32_t value);
 
 void sh_setGate(p600Gate_t gate,int8_t on);
 
+// locked CVs / gates ignore sh_setCV / sh_setGate (fast path excepted) until unlocked
+void sh_lock(uint32_t cvMask, uint8_t gateMask);
+
 void sh_init(void);
 void sh_update(void);
 
@@ -9,6 +9,7 @@
 #include "math.h"
 #include "midi.h"
 #include "display.h"
+#include <stddef.h>
 
 // increment this each time the binary format is changed
 #define STORAGE_VERSION 8
@@ -20,6 +21,32 @@
 
 #define STORAGE_MAX_SIZE (SETTINGS_PAGE_COUNT*STORAGE_PAGE_SIZE) // this is the buffer size, which must at least hold the settings data (see above)
 
+// sequencer header pages used to hold the events themselves, a rest with SEQ_CONT is never
+// a valid first event so it marks headers that point to an event stream instead
+#define SEQUENCER_LEGACY_EVENTS 128
+#define SEQUENCER_STREAM_MARKER (SEQ_REST|SEQ_CONT)
+
+// preset fields, as described by syxmgmt/preset.spec (run syxmgmt/gen_preset_layout.py after changing it)
+
+#define PF_WORD 1 // 16 bit values, 8 bit otherwise
+#define PF_UNUSED 2 // ignored on load, zero on save
+#define PF_MAX 4 // values above max are ignored on load
+
+struct presetField_s
+{
+	uint8_t since; // storage version
+	uint8_t flags;
+	uint8_t count;
+	uint8_t offset; // in struct preset_s
+	uint8_t max;
+};
+
+#include "preset_layout.h"
+
+#if PRESET_LAYOUT_VERSION!=STORAGE_VERSION
+#error "syxmgmt/preset.spec doesn't match STORAGE_VERSION"
+#endif
+
 const uint8_t steppedParameterRange[spCount] =
 {
     /* Osc A Saw */ 2,
@@ -215,6 +242,7 @@ LOWERCODESIZE int8_t settings_load(void)
 		settings.voiceMask=0x3f; // default is: all on
 		settings.midiSendChannel=0; // default is: 1
 		settings.syncMode=smInternal; // default is internal clock
+		settings.midiClockOut=0;
 		settings.vcfLimit=0; // default is: no limit on the VCF
 		settings.midiMode=0; // normal mode
 		settings.panelLayout=0; // GliGli layout
@@ -255,6 +283,8 @@ LOWERCODESIZE int8_t settings_load(void)
 		// v3
 		
 		settings.syncMode=storageRead8();
+		settings.midiClockOut=(settings.syncMode&0x80)!=0;
+		settings.syncMode&=0x7f;
 	
 		if (storage.version<4)
 			return 1;
@@ -321,7 +351,7 @@ LOWERCODESIZE void settings_save(void)
 
 		// v3
 		
-		storageWrite8(settings.syncMode);
+		storageWrite8(settings.syncMode|(settings.midiClockOut?0x80:0));
 		
 		// v4
 		
@@ -357,6 +387,7 @@ void settings_reset(void)
 	settings.voiceMask=0x3f; // default is: all on
 	settings.midiSendChannel=0; // default is: 1
 	settings.syncMode=smInternal; // default is internal clock
+	settings.midiClockOut=0;
 	settings.vcfLimit=0; // default is: no limit on the VCF
 	settings.midiMode=0; // normal mode
 	settings.panelLayout=0; // GliGli layout
@@ -376,11 +407,66 @@ LOWERCODESIZE int8_t preset_checkPage(uint16_t number)
 	return 1;
 }
 
+static void presetEqualTemperament(void)
+{
+	uint8_t i;
+
+	for (i=0; i<TUNER_NOTE_COUNT; i++)
+		currentPreset.perNoteTuning[i] = i?(((uint32_t)i<<16)-1)/12:0; // (uint16_t)(i*TUNING_UNITS_PER_SEMITONE) without floats, it is just below 65536/12
+}
+
+// remap of the values prior to version 8, old presets only so it may use floats (see softfloat in firmware/Makefile)
+static NOINLINE void presetRemapPreVersion8(void)
+{
+	// the legacy LFO speed range slot contains 1 for "fast"
+	// rescale the LFO speed (the speed switch parameter was omitted from version 8 after)
+	// the exponential factor (ratio) was changed from 13000 to 8000
+	currentPreset.continuousParameters[cpLFOFreq]=(uint16_t)(0.615385f*(float)currentPreset.continuousParameters[cpLFOFreq])+25205;
+	// The slow LFO variant in version 7 / 2.1RC3 was made a factor of 8 slower comapred to the fast setting, so:
+	if (currentPreset.steppedParameters[spLegacyLFORange]==0) currentPreset.continuousParameters[cpLFOFreq]-=16635; // =0 used to be the slow setting
+
+	// rescale the LFO amount as of version 8
+	// this is the inverse of the scaling functions applied to the LFO and vib amounts to make it smoother (small difference to stay within uint16_t here)
+	currentPreset.continuousParameters[cpLFOAmt]=(currentPreset.continuousParameters[cpLFOAmt]<=512)?0:(512+(uint16_t)(15000.0f*log((((float)(currentPreset.continuousParameters[cpLFOAmt]-512))/870.0f)+1)));
+
+	// remap the exponential release and decay times after the phase lookup was updated (made longer mapping theorectial 285 to new 256)
+	if (currentPreset.steppedParameters[spAmpEnvShape]==1) // exponential
+	{
+		currentPreset.continuousParameters[cpAmpRel]=(uint16_t)(currentPreset.continuousParameters[cpAmpRel]*0.895f);
+		currentPreset.continuousParameters[cpAmpDec]=(uint16_t)(currentPreset.continuousParameters[cpAmpDec]*0.895f);
+	}
+	currentPreset.continuousParameters[cpAmpAtt]=(uint16_t)(currentPreset.continuousParameters[cpAmpAtt]*0.895f);
+	if (currentPreset.steppedParameters[spFilEnvShape]==1) // exponential
+	{
+		currentPreset.continuousParameters[cpFilRel]=(uint16_t)(currentPreset.continuousParameters[cpFilRel]*0.895f);
+		currentPreset.continuousParameters[cpFilDec]=(uint16_t)(currentPreset.continuousParameters[cpFilDec]*0.895f);
+	}
+	currentPreset.continuousParameters[cpFilAtt]=(uint16_t)(currentPreset.continuousParameters[cpFilAtt]*0.895f);
+
+	if (storage.version>=2)
+	{
+		// rescale the vib amount as of version 8
+		// this is the inverse of the scaling functions applied to the LFO and vib amounts to make it smoother (small difference to stay within uint16_t here)
+		if (currentPreset.continuousParameters[cpVibAmt]<=2048)
+		{
+			currentPreset.continuousParameters[cpVibAmt]=0;
+		}
+		else
+		{
+			currentPreset.continuousParameters[cpVibAmt]=(uint16_t)(15000.0f*log((((float)(currentPreset.continuousParameters[cpVibAmt]-2048))/3480.0f)+1))+512;
+		}
+		// rescale the vib frequency; the exponential factor (ratio) was changed from 13000 to 8000.
+		currentPreset.continuousParameters[cpVibFreq]=(uint16_t)(0.615385f*(float)currentPreset.continuousParameters[cpVibFreq])+25205;
+	}
+}
+
 LOWERCODESIZE int8_t preset_loadCurrent(uint16_t number, uint8_t loadFromBuffer)
 {
 	uint8_t i;
-	int8_t readVar;
-	int16_t readVarLong;
+	uint16_t v;
+	uint8_t * target;
+	uint8_t idx;
+	struct presetField_s f;
 	
 	BLOCK_INT
 	{
@@ -417,128 +503,40 @@ LOWERCODESIZE int8_t preset_loadCurrent(uint16_t number, uint8_t loadFromBuffer)
 		if (storage.version<1)
 			return 1;
 
-		// v1
+		// fields are sorted by storage version, stop at the first one that is too recent
 		
-		continuousParameter_t cp;
-		for(cp=cpFreqA;cp<=cpFilVelocity;++cp)
-			currentPreset.continuousParameters[cp]=storageRead16();
-
-		steppedParameter_t sp;
-		for(sp=spASaw;sp<=spLFOShape;++sp)
-			currentPreset.steppedParameters[sp]=storageRead8();
-
-        readVar=storageRead8(); // this is legacy spLFOShift (see rescaling below, re-designated LFO Sync
-        if (storage.version<8)
-        {
-            // in this case readVar contains the legacy LFO speed range, where value 1 was "fast"
-            // rescale the LFO speed (the speed switch parameter was omitted from version 8 after)
-            // the exponential factor (ratio) was changed from 13000 to 8000
-            currentPreset.continuousParameters[cpLFOFreq]=(uint16_t)(0.615385f*(float)currentPreset.continuousParameters[cpLFOFreq])+25205;
-            // The slow LFO variant in version 7 / 2.1RC3 was made a factor of 8 slower comapred to the fast setting, so:
-            if (readVar==0) currentPreset.continuousParameters[cpLFOFreq]-=16635; // =0 used to be the slow setting
-
-        }
-
-		for(sp=spLFOTargets;sp<=spChromaticPitch;++sp)
-			currentPreset.steppedParameters[sp]=storageRead8();
-
-		// remap of the sp values prior to version 8
-        if (storage.version<8)
-        {
-            // rescale the LFO amount as of version 8
-            // this is the inverse of the scaling functions applied to the LFO and vib amounts to make it smoother (small difference to stay within uint16_t here)
-            currentPreset.continuousParameters[cpLFOAmt]=(currentPreset.continuousParameters[cpLFOAmt]<=512)?0:(512+(uint16_t)(15000.0f*log((((float)(currentPreset.continuousParameters[cpLFOAmt]-512))/870.0f)+1)));
-
-            // remap the exponential release and decay times after the phase lookup was updated (made longer mapping theorectial 285 to new 256)
-            if (currentPreset.steppedParameters[spAmpEnvShape]==1) // exponential
-            {
-                currentPreset.continuousParameters[cpAmpRel]=(uint16_t)(currentPreset.continuousParameters[cpAmpRel]*0.895f);
-                currentPreset.continuousParameters[cpAmpDec]=(uint16_t)(currentPreset.continuousParameters[cpAmpDec]*0.895f);
-            }
-            currentPreset.continuousParameters[cpAmpAtt]=(uint16_t)(currentPreset.continuousParameters[cpAmpAtt]*0.895f);
-            if (currentPreset.steppedParameters[spFilEnvShape]==1) // exponential
-            {
-                currentPreset.continuousParameters[cpFilRel]=(uint16_t)(currentPreset.continuousParameters[cpFilRel]*0.895f);
-                currentPreset.continuousParameters[cpFilDec]=(uint16_t)(currentPreset.continuousParameters[cpFilDec]*0.895f);
-            }
-            currentPreset.continuousParameters[cpFilAtt]=(uint16_t)(currentPreset.continuousParameters[cpFilAtt]*0.895f);
-        }
-		
-		currentPreset.steppedParameters[spAmpEnvSlow]=currentPreset.steppedParameters[holdPedal];
-
-        // update mixer variables depending on panel layout
-        mixer_updatePanelLayout(settings.panelLayout);
-
-		if (storage.version<2)
-			return 1;
-
-		// v2
-
-		for(cp=cpModDelay;cp<=cpSeqArpClock;++cp) // need to read out speed (last param, cpSeqArpClock) but not use, see below. speed is part of settings
-			currentPreset.continuousParameters[cp]=storageRead16();
-
-		currentPreset.continuousParameters[cpSeqArpClock]=settings.seqArpClock; // display uses current preset param, so replicate it from settings
+		for(idx=0;idx<PRESET_FIELD_COUNT;++idx)
+		{
+			memcpy_P(&f,&presetLayout[idx],sizeof(f));
+			if(f.since>storage.version)
+				break;
 
-		for(sp=spModwheelTarget;sp<=spVibTarget;++sp)
-			currentPreset.steppedParameters[sp]=storageRead8();
+			target=(uint8_t*)&currentPreset+f.offset;
+			for(i=0;i<f.count;++i)
+			{
+				v=(f.flags&PF_WORD)?storageRead16():storageRead8();
 
-		for(i=0;i<SYNTH_VOICE_COUNT;++i)
-			currentPreset.voicePattern[i]=storageRead8();
+				if((f.flags&PF_UNUSED) || ((f.flags&PF_MAX) && v>f.max)) // invalid values: default stays
+					continue;
 
-        // remap of the sp values prior to version 8
-        if (storage.version<8)
-        {
-            // rescale the vib amount as of version 8
-            // this is the inverse of the scaling functions applied to the LFO and vib amounts to make it smoother (small difference to stay within uint16_t here)
-			if (currentPreset.continuousParameters[cpVibAmt]<=2048)
-			{
-				currentPreset.continuousParameters[cpVibAmt]=0;
-			}
-			else
-			{
-				currentPreset.continuousParameters[cpVibAmt]=(uint16_t)(15000.0f*log((((float)(currentPreset.continuousParameters[cpVibAmt]-2048))/3480.0f)+1))+512;
+				if(f.flags&PF_WORD)
+					((uint16_t*)target)[i]=v;
+				else
+					target[i]=v;
 			}
-            // rescale the vib frequency; the exponential factor (ratio) was changed from 13000 to 8000.
-            currentPreset.continuousParameters[cpVibFreq]=(uint16_t)(0.615385f*(float)currentPreset.continuousParameters[cpVibFreq])+25205;
-        }
-
-		if (storage.version<7)
-			return 1;
+		}
 
-		// v7
-		
-        for (i=0; i<TUNER_NOTE_COUNT; i++)
-        {
-            readVarLong=storageRead16();
-            if (number!=MANUAL_PRESET_PAGE || loadFromBuffer) currentPreset.perNoteTuning[i]=readVarLong; // always reset equal tempered tuning for manual mode: keep defaults
-        }
-			
 		if (storage.version<8)
-        {
-			return 1;
-        }
-	
-		// V8
+			presetRemapPreVersion8();
 
-		readVar=storageRead8();
-		if (readVar<=1) // only accept valid values, otherwise default stays
-			currentPreset.steppedParameters[spPWMBug]=readVar;
-
-        currentPreset.continuousParameters[cpSpread]=storageRead16();
-        currentPreset.continuousParameters[cpExternal]=storageRead16();
-
-        readVar=storageRead8(); // this is legacy mod wheel strength re-designated LFO Sync
-        if (readVar<=3) currentPreset.steppedParameters[spEnvRouting]=readVar;
-
-        readVar=storageRead8();
-        currentPreset.steppedParameters[spAssign]=(readVar>1)?0:readVar;
-
-		readVar=storageRead8();
-		currentPreset.steppedParameters[spLFOSync]=(readVar>7)?0:readVar;
+		currentPreset.steppedParameters[spLegacyLFORange]=0;
+		currentPreset.steppedParameters[spAmpEnvSlow]=currentPreset.steppedParameters[holdPedal];
 
-        for (i=0;i < 16; i++)
-            currentPreset.patchName[i]=storageRead8();
+		if (number==MANUAL_PRESET_PAGE && !loadFromBuffer)
+			presetEqualTemperament(); // always reset equal tempered tuning for manual mode
 
+        // update mixer variables depending on panel layout
+        mixer_updatePanelLayout(settings.panelLayout);
 	}
 	
 	return 1;
@@ -547,84 +545,113 @@ LOWERCODESIZE int8_t preset_loadCurrent(uint16_t number, uint8_t loadFromBuffer)
 LOWERCODESIZE void preset_saveCurrent(uint16_t number)
 {
 	uint8_t i;
+	uint8_t * source;
+	uint8_t idx;
+	struct presetField_s f;
 	
 	BLOCK_INT
 	{
 		storagePrepareStore();
 
-		// v1
-
-		continuousParameter_t cp;
-		for(cp=cpFreqA;cp<=cpFilVelocity;++cp)
-			storageWrite16(currentPreset.continuousParameters[cp]);
-
 		currentPreset.steppedParameters[holdPedal]=currentPreset.steppedParameters[spAmpEnvSlow];
 
-		steppedParameter_t sp;
-		for(sp=spASaw;sp<=spChromaticPitch;++sp)
-			storageWrite8(currentPreset.steppedParameters[sp]);
-		
-		// v2
-		
-		for(cp=cpModDelay;cp<cpSeqArpClock;++cp) // skip arp/seq clock
-			storageWrite16(currentPreset.continuousParameters[cp]);
+		for(idx=0;idx<PRESET_FIELD_COUNT;++idx)
+		{
+			memcpy_P(&f,&presetLayout[idx],sizeof(f));
 
-        // to avoid confusion, write zero to the arp/seq clock slot
-        storageWrite16(0);
+			source=(uint8_t*)&currentPreset+f.offset;
+			for(i=0;i<f.count;++i)
+			{
+				if(f.flags&PF_UNUSED) // to avoid confusion, unused slots are zero
+					storage.bufPtr+=(f.flags&PF_WORD)?sizeof(uint16_t):sizeof(uint8_t);
+				else if(f.flags&PF_WORD)
+					storageWrite16(((uint16_t*)source)[i]);
+				else
+					storageWrite8(source[i]);
+			}
+		}
 
-		for(sp=spModwheelTarget;sp<=spVibTarget;++sp)
-			storageWrite8(currentPreset.steppedParameters[sp]);
+		// this must stay last
+		storageFinishStore(number,1); // yes, one page is enough
+	}
+}
 
-		for(i=0;i<SYNTH_VOICE_COUNT;++i)
-			storageWrite8(currentPreset.voicePattern[i]);
+static uint16_t sequencerEventAddress(int8_t track, uint16_t index)
+{
+	return (SEQUENCER_EVENT_PAGE+track*SEQUENCER_TRACK_PAGES)*STORAGE_PAGE_SIZE+index;
+}
 
+LOWERCODESIZE void storage_saveSequencer(int8_t track, uint16_t eventCount, uint16_t stepCount)
+{
+	BLOCK_INT
+	{
+		storagePrepareStore();
 
-        for (i=0; i<TUNER_NOTE_COUNT; i++)
-			storageWrite16(currentPreset.perNoteTuning[i]);
-			
-		// v8
+		storageWrite8(SEQUENCER_STREAM_MARKER);
+		storageWrite16(eventCount);
+		storageWrite16(stepCount);
 		
-		storageWrite8(currentPreset.steppedParameters[spPWMBug]);
-		storageWrite16(currentPreset.continuousParameters[cpSpread]);
-		storageWrite16(currentPreset.continuousParameters[cpExternal]);
-        storageWrite8(currentPreset.steppedParameters[spEnvRouting]);
-        storageWrite8(currentPreset.steppedParameters[spAssign]);
-        storageWrite8(currentPreset.steppedParameters[spLFOSync]);
-
-        for (i=0;i < 16; i++)
-            storageWrite8(currentPreset.patchName[i]);
-
-
 		// this must stay last
-		storageFinishStore(number,1); // yes, one page is enough
+		storageFinishStore(SEQUENCER_START_PAGE+track,1);
 	}
 }
 
-LOWERCODESIZE int8_t storage_loadSequencer(int8_t track, uint8_t * data, uint8_t size)
+LOWERCODESIZE int8_t storage_loadSequencer(int8_t track, uint16_t * eventCount, uint16_t * stepCount)
 {
+	uint8_t s;
+	
 	BLOCK_INT
 	{
 		if (!storageLoad(SEQUENCER_START_PAGE+track,1))
 			return 0;
 		
-		while(size--)
-			*data++=storageRead8();
+		if(storageRead8()==SEQUENCER_STREAM_MARKER)
+		{
+			*eventCount=storageRead16();
+			*stepCount=storageRead16();
+			
+			if(*eventCount>SEQ_EVENT_MEMORY)
+				return 0;
+		}
+		else
+		{
+			// older format, move the events to the stream
+			
+			storage.bufPtr-=sizeof(uint8_t);
+
+			*eventCount=0;
+			*stepCount=0;
+			while(*eventCount<SEQUENCER_LEGACY_EVENTS)
+			{
+				s=storage.bufPtr[*eventCount];
+				if(s==ASSIGNER_NO_NOTE)
+					break;
+				if(!(s&SEQ_CONT))
+					++*stepCount;
+				++*eventCount;
+			}
+			
+			storage_writeBytes(sequencerEventAddress(track,0),storage.bufPtr,*eventCount);
+			storage_saveSequencer(track,*eventCount,*stepCount);
+		}
 	}
 	
 	return 1;
 }
 
-LOWERCODESIZE void storage_saveSequencer(int8_t track, uint8_t * data, uint8_t size)
+LOWERCODESIZE void storage_readSequencerEvents(int8_t track, uint16_t index, uint8_t * data, uint8_t size)
 {
 	BLOCK_INT
 	{
-		storagePrepareStore();
+		storage_readBytes(sequencerEventAddress(track,index),data,size);
+	}
+}
 
-		while(size--)
-			storageWrite8(*data++);
-		
-		// this must stay last
-		storageFinishStore(SEQUENCER_START_PAGE+track,1);
+LOWERCODESIZE void storage_writeSequencerEvents(int8_t track, uint16_t index, uint8_t * data, uint8_t size)
+{
+	BLOCK_INT
+	{
+		storage_writeBytes(sequencerEventAddress(track,index),data,size);
 	}
 }
 
@@ -687,8 +714,6 @@ LOWERCODESIZE void storage_import(uint16_t number, uint8_t * buf, int16_t size)
 
 LOWERCODESIZE void preset_loadDefault(int8_t makeSound)
 {
-	uint8_t i;
-    
 	BLOCK_INT
 	{
 		memset(&currentPreset,0,sizeof(currentPreset));
@@ -716,8 +741,7 @@ LOWERCODESIZE void preset_loadDefault(int8_t makeSound)
 		memset(currentPreset.voicePattern,ASSIGNER_NO_NOTE,sizeof(currentPreset.voicePattern));
 
 		// Default tuning is equal tempered
-		for (i=0; i<TUNER_NOTE_COUNT; i++)
-			currentPreset.perNoteTuning[i] = i * TUNING_UNITS_PER_SEMITONE;
+		presetEqualTemperament();
 
 		if(makeSound)
 			currentPreset.steppedParameters[spASaw]=1;
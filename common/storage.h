@@ -4,9 +4,13 @@
 #include "synth.h"
 #include "tuner.h"
 #include "assigner.h"
+#include "seq.h"
 
 #define MANUAL_PRESET_PAGE ((STORAGE_SIZE/STORAGE_PAGE_SIZE)-5)
-#define SEQUENCER_START_PAGE 200
+#define SEQUENCER_START_PAGE 200 // one header page per track
+#define SEQUENCER_EVENT_PAGE (SEQUENCER_START_PAGE+SEQ_TRACK_COUNT) // then the event streams, up to the manual preset
+#define SEQUENCER_TRACK_PAGES ((MANUAL_PRESET_PAGE-SEQUENCER_EVENT_PAGE)/SEQ_TRACK_COUNT)
+#define SEQ_EVENT_MEMORY ((uint16_t)(SEQUENCER_TRACK_PAGES*STORAGE_PAGE_SIZE))
 
 typedef enum
 {
@@ -44,6 +48,7 @@ typedef enum
 	spSync=6,spPModFA=7,spPModFil=8,
 			
 	spLFOShape=9,
+	spLegacyLFORange=10, // only read from presets prior to storage version 8
     spLFOTargets=11,
 
 	spTrackingShift=12,
@@ -84,6 +89,7 @@ struct settings_s
 	uint8_t voiceMask;
 	
 	int8_t syncMode;
+	int8_t midiClockOut; // internal sync only, stored in the sync mode top bit
 	
 	int8_t vcfLimit;
 	
@@ -129,8 +135,10 @@ void storage_simpleExport(uint16_t number, uint8_t * buf, int16_t size);
 void storage_export(uint16_t number, uint8_t * buf, int16_t * loadedSize);
 void storage_import(uint16_t number, uint8_t * buf, int16_t size);
 
-int8_t storage_loadSequencer(int8_t track, uint8_t * data, uint8_t size);
-void storage_saveSequencer(int8_t track, uint8_t * data, uint8_t size);
+int8_t storage_loadSequencer(int8_t track, uint16_t * eventCount, uint16_t * stepCount);
+void storage_saveSequencer(int8_t track, uint16_t eventCount, uint16_t stepCount);
+void storage_readSequencerEvents(int8_t track, uint16_t index, uint8_t * data, uint8_t size);
+void storage_writeSequencerEvents(int8_t track, uint16_t index, uint8_t * data, uint8_t size);
 
 #endif	/* STORAGE_H */
 
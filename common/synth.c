@@ -39,6 +39,8 @@
 #define BIT_INTPUT_FOOTSWITCH 0x20
 #define BIT_INTPUT_TAPE_IN 0x01
 
+#define SYNTH_OVERRUN_SHEDDING_TICKS 250 // 125ms at 2khz, after the last timer interrupt overrun
+
 uint8_t tempBuffer[TEMP_BUFFER_SIZE]; // general purpose chunk of RAM
 
 const p600Pot_t continuousParameterToPot[cpCount]=
@@ -121,12 +123,22 @@ struct synth_s
 
     uint8_t freqDial;
 
+    // timer interrupt overruns, deferrable work is shed while sheddingTicks isn't 0
+    uint16_t overrunCount;
+    uint16_t missedTickCount;
+    uint8_t sheddingTicks;
+
+    // modulations of the last tick, for the envelope sub-step
+    int16_t tickFilEnvAmt,tickFilterLfoVal;
+    uint16_t tickAmpLfoVal;
+    int8_t tickBgVoice;
+
     // uint32_t updateCounter; // for performance measurement
 
 } synth;
 
 extern void refreshAllPresetButtons(void);
-extern const uint16_t attackCurveLookup[]; // for modulation delay
+extern const PROGMEM uint16_t attackCurveLookup[]; // for modulation delay
 
 struct deadband {
     uint16_t middle;
@@ -195,11 +207,17 @@ static void computeTunedOffsetCVs(void) // this function must always be called a
     for(cv=pcOsc1A; cv<=pcFil6; ++cv)
     {
         synth.tunedBenderCVs[cv]=tuner_computeCVFromNote(currentPreset.steppedParameters[spBenderSemitones]*4,0,cv)-tuner_computeCVFromNote(0,0,cv);
-        if (cv<=pcOsc6B) synth.tunedOctaveCVs[cv]=(uint16_t)((tuner_computeCVFromNote(48,0,cv)-tuner_computeCVFromNote(0,0,cv))*2.5f);
+        if (cv<=pcOsc6B) synth.tunedOctaveCVs[cv]=((uint32_t)(tuner_computeCVFromNote(48,0,cv)-tuner_computeCVFromNote(0,0,cv))*5)>>1; // 2.5 times
     }
 }
 
 
+static FORCEINLINE int16_t scaleDetune(int16_t detune, uint16_t cv)
+{
+    // detune*(1-cv/65536), truncated towards zero
+    return ((int32_t)detune*(65536L-cv))/65536L;
+}
+
 static void computeTunedCVs(int8_t force, int8_t forceVoice)
 {
 
@@ -373,9 +391,9 @@ static void computeTunedCVs(int8_t force, int8_t forceVoice)
         {
             detune=(1+(v>>1))*(v&1?-1:1)*(detuneRaw>>8);
             // scale detune with tone, e.g. less pronounced at higher frequencies
-            synth.oscABaseCV[v]=satAddU16S16(synth.oscABaseCV[v],(int16_t)(detune*(1.0f-(2.0f*(float)synth.oscABaseCV[v])/131072.0f)));
-            synth.oscBBaseCV[v]=satAddU16S16(synth.oscBBaseCV[v],(int16_t)(detune*(1.0f-(2.0f*(float)synth.oscBBaseCV[v])/131072.0f)));
-            synth.filterBaseCV[v]=satAddU16S16(synth.filterBaseCV[v],(int16_t)(detune*(1.0f-(2.0f*(float)synth.filterBaseCV[v])/131072.0f)));
+            synth.oscABaseCV[v]=satAddU16S16(synth.oscABaseCV[v],scaleDetune(detune,synth.oscABaseCV[v]));
+            synth.oscBBaseCV[v]=satAddU16S16(synth.oscBBaseCV[v],scaleDetune(detune,synth.oscBBaseCV[v]));
+            synth.filterBaseCV[v]=satAddU16S16(synth.filterBaseCV[v],scaleDetune(detune,synth.filterBaseCV[v]));
         }
 
         // bender and tune
@@ -587,7 +605,7 @@ static void refreshModDelayLFORetrigger(int8_t refreshDelayTickCount)
     prevAnyPressed=anyPressed;
 
     if(refreshDelayTickCount)
-        synth.modulationDelayTickCount=exponentialCourse(UINT16_MAX-currentPreset.continuousParameters[cpModDelay],12000.0f,2500.0f);
+        synth.modulationDelayTickCount=exponentialCourse(UINT16_MAX-currentPreset.continuousParameters[cpModDelay],EXPONENTIAL_COURSE_RATE(12000.0),2500);
 }
 
 static void handleFinishedVoices(void)
@@ -628,6 +646,12 @@ static void refreshGates(void)
     sh_setGate(pgPModFil,currentPreset.steppedParameters[spPModFil]);
 }
 
+static inline uint16_t scaleExternal(uint16_t v)
+{
+    // 0.4*v, the same as the former (uint16_t)(0.4f*v) for every v
+    return ((uint32_t)v*52429)>>17;
+}
+
 static inline void refreshPulseWidth(int8_t pwm)
 {
     int32_t pa,pb;
@@ -685,7 +709,7 @@ static void refreshEnvSettings(void)
     int8_t i, v_aux;
     uint16_t as, fs;
     uint16_t aa,ad,ar,fa,fd,fr;
-    float spread;
+    int16_t spread;
 
     as=currentPreset.continuousParameters[cpAmpSus]; // there is no spread on the sustain
     fs=currentPreset.continuousParameters[cpFilSus]; // there is no spread on the sustain
@@ -700,7 +724,7 @@ static void refreshEnvSettings(void)
 
         if (currentPreset.continuousParameters[cpSpread]>1000)
         {
-            spread=(int16_t)((currentPreset.continuousParameters[cpSpread]>>4)); // the bit shift determines the overall effect strength of the spread
+            spread=currentPreset.continuousParameters[cpSpread]>>4; // the bit shift determines the overall effect strength of the spread
         }
         else
         {
@@ -708,18 +732,18 @@ static void refreshEnvSettings(void)
         }
 
         v_aux=(i+1)%6;
-        aa=scaleProportionalU16S16(currentPreset.continuousParameters[cpAmpAtt],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread/1.5f);
+        aa=scaleProportionalU16S16(currentPreset.continuousParameters[cpAmpAtt],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread*2/3); // spread/1.5
         v_aux=(i+2)%6;
         ad=scaleProportionalU16S16(currentPreset.continuousParameters[cpAmpDec],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread);
         v_aux=(i+3)%6;
-        ar=scaleProportionalU16S16(currentPreset.continuousParameters[cpAmpRel],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread/2.0f);
+        ar=scaleProportionalU16S16(currentPreset.continuousParameters[cpAmpRel],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread/2);
 
         v_aux=(i+4)%6;
-        fa=scaleProportionalU16S16(currentPreset.continuousParameters[cpFilAtt],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread/1.5f);
+        fa=scaleProportionalU16S16(currentPreset.continuousParameters[cpFilAtt],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread*2/3);
         v_aux=(i+5)%6;
         fd=scaleProportionalU16S16(currentPreset.continuousParameters[cpFilDec],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread);
         v_aux=i;
-        fr=scaleProportionalU16S16(currentPreset.continuousParameters[cpFilRel],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread/2.0f);
+        fr=scaleProportionalU16S16(currentPreset.continuousParameters[cpFilRel],(1+(v_aux>>1))*(v_aux&1?-1:1)*spread/2);
 
         adsr_setCVs(&synth.ampEnvs[i],aa,ad,as,ar,0,0x0f);
         adsr_setCVs(&synth.filEnvs[i],fa,fd,fs,fr,0,0x0f);
@@ -747,7 +771,7 @@ static void refreshDlyAmount(void)
             if(elapsed>=synth.modulationDelayTickCount)
                 synth.dlyAmt=UINT16_MAX;
             else
-                synth.dlyAmt=attackCurveLookup[(elapsed<<8)/synth.modulationDelayTickCount];
+                synth.dlyAmt=pgm_read_word(&attackCurveLookup[(elapsed<<8)/synth.modulationDelayTickCount]);
         }
     }
 }
@@ -763,7 +787,7 @@ static void refreshLfoSettings(void)
 
     synth.lfoAmt=currentPreset.continuousParameters[cpLFOAmt];
     synth.lfoAmt=(synth.lfoAmt<POT_DEAD_ZONE)?0:(synth.lfoAmt-POT_DEAD_ZONE);
-    synth.lfoAmt=((expf(((float)synth.lfoAmt)/15000.0f )-1.0f)*870.0f);
+    synth.lfoAmt=exponentialRise(synth.lfoAmt,EXPONENTIAL_COURSE_RATE(15000.0),870);
 
     lfo_setFreq(&synth.lfo,currentPreset.continuousParameters[cpLFOFreq]);
 
@@ -780,7 +804,7 @@ static void refreshSevenSeg(void) // imogen: this function would be more suited
     if(seqRec) // sequence record mode and no parameter selection override, e.g. the input and display is sequencer
     {
         int8_t track=(seq_getMode(1)==smRecording)?1:0;
-        uint8_t count=seq_getStepCount(track);
+        uint16_t count=seq_getStepCount(track);
         int8_t full=seq_full(track);
         sevenSeg_setNumber(count);
         led_set(plDot,count>=100||full,full); // set blinking when full!
@@ -1075,9 +1099,43 @@ void refreshPresetMode(void)
 
 }
 
+static FORCEINLINE void refreshFilterAndAmp(int8_t v,uint16_t envVal,uint16_t ampEnvVal,int16_t filEnvAmt,int16_t filterLfoVal,uint16_t ampLfoVal)
+{
+    int32_t va,vf;
+
+    // filter
+
+    vf=filterLfoVal;
+    vf+=scaleU16S16(envVal,filEnvAmt);
+    vf+=synth.filterNoteCV[v];
+
+    if(vf>synth.filterMaxCV[v])
+        vf=synth.filterMaxCV[v];
+
+    sh_setCV32Sat_FastPath(pcFil1+v,vf);
+
+    // apply amplifier
+
+    if (currentPreset.steppedParameters[spEnvRouting]==2) // the poly case, e.g. amplitude via filter envelope
+        va=scaleU16U16(envVal,ampLfoVal);
+    else if (currentPreset.steppedParameters[spEnvRouting]==3) // this is the gate case for amplitude
+    {
+        va=0;
+        if (adsr_getStage(&synth.ampEnvs[v])>=sAttack&&adsr_getStage(&synth.ampEnvs[v])<=sSustain)
+            va=scaleU16U16(FULL_RANGE,ampLfoVal); // this behaves like a gate shape
+    }
+    else // standard
+        va=scaleU16U16(ampEnvVal,ampLfoVal);
+
+    if(va)
+        va+=VCA_DEADBAND;
+
+    sh_setCV32Sat_FastPath(pcAmp1+v,va);
+}
+
 static FORCEINLINE void refreshVoice(int8_t v,int16_t oscEnvAmt,int16_t filEnvAmt,int16_t pitchALfoVal,int16_t pitchBLfoVal,int16_t filterLfoVal,uint16_t ampLfoVal)
 {
-    int32_t va,vb,vf;
+    int32_t va,vb;
     uint16_t envVal;
     uint16_t ampEnvVal;
 
@@ -1108,34 +1166,33 @@ static FORCEINLINE void refreshVoice(int8_t v,int16_t oscEnvAmt,int16_t filEnvAm
         va+=synth.oscANoteCV[v];
         sh_setCV32Sat_FastPath(pcOsc1A+v,va);
 
-        // filter
-
-        vf=filterLfoVal;
-        vf+=scaleU16S16(envVal,filEnvAmt);
-        vf+=synth.filterNoteCV[v];
+        refreshFilterAndAmp(v,envVal,ampEnvVal,filEnvAmt,filterLfoVal,ampLfoVal);
+    }
+}
 
-        if(vf>synth.filterMaxCV[v])
-            vf=synth.filterMaxCV[v];
+static FORCEINLINE int8_t isFastStage(struct adsr_s * a)
+{
+    return a->stage==sAttack || a->stage==sDecay;
+}
 
-        sh_setCV32Sat_FastPath(pcFil1+v,vf);
+// filter and amp CVs once more, half way through the 2khz tick, for voices with an envelope in attack or decay
+void synth_timerSubStep(void)
+{
+    int8_t v;
+    uint16_t envVal,ampEnvVal;
 
-        // apply amplifier
+    for(v=0; v<SYNTH_VOICE_COUNT; ++v)
+    {
+        if(v==synth.tickBgVoice || !(isFastStage(&synth.filEnvs[v]) || isFastStage(&synth.ampEnvs[v])))
+            continue;
 
-        if (currentPreset.steppedParameters[spEnvRouting]==2) // the poly case, e.g. amplitude via filter envelope
-            va=scaleU16U16(envVal,ampLfoVal);
-        else if (currentPreset.steppedParameters[spEnvRouting]==3) // this is the gate case for amplitude
+        BLOCK_INT
         {
-            va=0;
-            if (adsr_getStage(&synth.ampEnvs[v])>=sAttack&&adsr_getStage(&synth.ampEnvs[v])<=sSustain)
-                va=scaleU16U16(FULL_RANGE,ampLfoVal); // this behaves like a gate shape
-        }
-        else // standard
-            va=scaleU16U16(ampEnvVal,ampLfoVal);
-
-        if(va)
-            va+=VCA_DEADBAND;
+            envVal=adsr_getHalfStepOutput(&synth.filEnvs[v]);
+            ampEnvVal=adsr_getHalfStepOutput(&synth.ampEnvs[v]);
 
-        sh_setCV32Sat_FastPath(pcAmp1+v,va);
+            refreshFilterAndAmp(v,envVal,ampEnvVal,synth.tickFilEnvAmt,synth.tickFilterLfoVal,synth.tickAmpLfoVal);
+        }
     }
 }
 
@@ -1250,7 +1307,7 @@ void synth_init(void)
     // initial input state
 
     scanner_update(1);
-    potmux_update(1); // init all
+    potmux_update(1,0); // init all
 
     // load last preset & do a full refresh
     refreshPresetMode();
@@ -1285,7 +1342,7 @@ void synth_update(void)
     // update pots, detecting change
 
     potmux_resetChanged();
-    potmux_update(0);
+    potmux_update(0,synth.sheddingTicks!=0);
 
     // act on pot change
 
@@ -1348,7 +1405,7 @@ void synth_update(void)
         }
         else
         {
-            synth.glideAmount=exponentialCourse(currentPreset.continuousParameters[cpGlide],11000.0f,2100.0f);
+            synth.glideAmount=exponentialCourse(currentPreset.continuousParameters[cpGlide],EXPONENTIAL_COURSE_RATE(11000.0),2100);
             synth.gliding=synth.glideAmount<2000;
         }
     }
@@ -1357,7 +1414,7 @@ void synth_update(void)
     {
         synth.vibAmt=currentPreset.continuousParameters[cpVibAmt];
         synth.vibAmt=(synth.vibAmt<POT_DEAD_ZONE)?0:(synth.vibAmt-POT_DEAD_ZONE);
-        synth.vibAmt=((expf(((float)synth.vibAmt)/15000.0f )-1.0f)*870.0f);
+        synth.vibAmt=exponentialRise(synth.vibAmt,EXPONENTIAL_COURSE_RATE(15000.0),870);
         ui.vibAmountChangePending=0;
     }
 
@@ -1385,7 +1442,7 @@ void synth_update(void)
             sh_setCV(pcMVol,satAddU16S16(synth.masterVolume,synth.benderVolumeCV),SH_FLAG_IMMEDIATE);
             break;
         case 3:
-            sh_setCV(pcExtFil,(uint16_t)(0.4f*((float)currentPreset.continuousParameters[cpExternal])),SH_FLAG_IMMEDIATE); // max voltage on hardware is reached for about 0.4 of uint16_t. This sclaling optimizes the parameter travel
+            sh_setCV(pcExtFil,scaleExternal(currentPreset.continuousParameters[cpExternal]),SH_FLAG_IMMEDIATE); // max voltage on hardware is reached for about 0.4 of uint16_t. This sclaling optimizes the parameter travel
             break;
         case 4:
             sh_setCV(pcVolA,currentPreset.continuousParameters[cpVolA],SH_FLAG_IMMEDIATE);
@@ -1400,23 +1457,44 @@ void synth_update(void)
             break;
         case 7:
             refreshGates();
-            synth.glideAmount=exponentialCourse(currentPreset.continuousParameters[cpGlide],11000.0f,2100.0f);
+            synth.glideAmount=exponentialCourse(currentPreset.continuousParameters[cpGlide],EXPONENTIAL_COURSE_RATE(11000.0),2100);
             synth.gliding=synth.glideAmount<2000;
             // arp and seq
             clock_setSpeed(settings.seqArpClock);
+            clock_updateTransport(seq_getMode(0)>=smPlaying || seq_getMode(1)>=smPlaying || arp_getMode()!=amOff);
             break;
     }
 
     // tuned CVs
 
     computeTunedCVs(0,-1);
+
+    // background retune, once it's done, given up or paused the held CVs must be restored
+
+    if(tuner_backgroundUpdate(!assigner_getAnyAssigned() && arp_getMode()==amOff && seq_getMode(0)==smOff && seq_getMode(1)==smOff))
+    {
+        computeTunedOffsetCVs();
+        refreshGates();
+        sh_setCV(pcMVol,satAddU16S16(synth.masterVolume,synth.benderVolumeCV),SH_FLAG_IMMEDIATE);
+        sh_setCV(pcVolA,currentPreset.continuousParameters[cpVolA],SH_FLAG_IMMEDIATE);
+        sh_setCV(pcVolB,currentPreset.continuousParameters[cpVolB],SH_FLAG_IMMEDIATE);
+        sh_setCV(pcResonance,currentPreset.continuousParameters[cpResonance],SH_FLAG_IMMEDIATE);
+        sh_setCV(pcPModOscB,currentPreset.continuousParameters[cpPModOscB],SH_FLAG_IMMEDIATE);
+        sh_setCV(pcExtFil,scaleExternal(currentPreset.continuousParameters[cpExternal]),SH_FLAG_IMMEDIATE);
+    }
 }
 
 void synth_tuneSynth(void)
 {
+    char s[20]="tuned ";
+
     tuner_tuneSynth();
     computeTunedOffsetCVs();
     synth_updateMasterVolume();
+
+    itoa(tuner_getProbeCount(),&s[6],10);
+    strcat(s," probes");
+    sevenSeg_scrollText(s,1);
 }
 
 
@@ -1430,15 +1508,47 @@ void synth_uartInterrupt(void)
 }
 
 // 2Khz
+static void clockStep(void)
+{
+    // sync of the LFO using the clockBar counter
+
+    synth.clockBar=(synth.clockBar+1)%0x9; // make sure the counter stays within the counter range, here 0...9
+    if (currentPreset.steppedParameters[spLFOSync]>1)
+    {
+        if(seq_getMode(0)!=smOff || seq_getMode(1)!=smOff || arp_getMode()!=amOff)
+        {
+            if ((synth.clockBar==8 && currentPreset.steppedParameters[spLFOSync]==8) || synth.clockBar+1==currentPreset.steppedParameters[spLFOSync])
+            {
+                synth.clockBar=0;
+                lfo_resetPhase(&synth.lfo);
+            }
+        }
+    }
+
+    // sequencer
+
+    if(seq_getMode(0)!=smOff || seq_getMode(1)!=smOff)
+        seq_update();
+
+    // arpeggiator
+
+    if(arp_getMode()!=amOff)
+        arp_update();
+}
+
 void synth_timerInterrupt(void)
 {
     uint32_t va, vf;
     int16_t pitchALfoVal,pitchBLfoVal,filterLfoVal,filEnvAmt,oscEnvAmt;
     uint16_t ampLfoVal;
-    int8_t v,hz63,hz250;
+    int8_t v,hz63,hz250,bgVoice,shedding;
 
     static uint8_t frc=0;
 
+    shedding=synth.sheddingTicks!=0;
+    if(shedding)
+        --synth.sheddingTicks;
+
     // performance
 	// static uint16_t frc2=0; // for performance measurement
 
@@ -1495,18 +1605,40 @@ void synth_timerInterrupt(void)
 
     // per voice stuff
 
-    // SYNTH_VOICE_COUNT calls
-    refreshVoice(0,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
-    refreshVoice(1,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
-    refreshVoice(2,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
-    refreshVoice(3,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
-    refreshVoice(4,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
-    refreshVoice(5,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
+    // SYNTH_VOICE_COUNT calls, the voice being retuned in background is left to the tuner
+    bgVoice=tuner_getBackgroundVoice();
+
+    synth.tickFilEnvAmt=filEnvAmt;
+    synth.tickFilterLfoVal=filterLfoVal;
+    synth.tickAmpLfoVal=ampLfoVal;
+    synth.tickBgVoice=bgVoice;
+
+    if(bgVoice!=0) refreshVoice(0,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
+    if(bgVoice!=1) refreshVoice(1,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
+    if(bgVoice!=2) refreshVoice(2,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
+    if(bgVoice!=3) refreshVoice(3,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
+    if(bgVoice!=4) refreshVoice(4,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
+    if(bgVoice!=5) refreshVoice(5,oscEnvAmt,filEnvAmt,pitchALfoVal,pitchBLfoVal,filterLfoVal,ampLfoVal);
 
     // bit inputs (footswitch / tape in)
 
     handleBitInputs();
 
+    // sequencer & arpeggiator, the clock runs at full rate so that steps aren't quantized to 500hz
+
+    if (clock_update())
+        clockStep();
+
+    if(synth.pendingExtClock) // tape sync
+    {
+        --synth.pendingExtClock;
+
+        if (clock_externalPulse())
+            clockStep();
+    }
+
+    midi_updateRealtime();
+
     // slower updates
 
     hz63=(frc&0x1c)==0;
@@ -1515,7 +1647,7 @@ void synth_timerInterrupt(void)
     switch(frc&0x03) // 4 phases, each 500hz
     {
     case 0:
-        if(hz63)
+        if(hz63 && !shedding)
             handleFinishedVoices();
 
         // MIDI processing
@@ -1526,44 +1658,6 @@ void synth_timerInterrupt(void)
 
         break;
     case 1:
-
-        // sequencer & arpeggiator
-
-        if(settings.syncMode==smInternal || synth.pendingExtClock)
-        {
-            if(synth.pendingExtClock)
-                --synth.pendingExtClock;
-
-            if (clock_update())
-            {
-
-                // sync of the LFO using the clockBar counter
-
-                synth.clockBar=(synth.clockBar+1)%0x9; // make sure the counter stays within the counter range, here 0...9
-                if (currentPreset.steppedParameters[spLFOSync]>1)
-                {
-                    if(seq_getMode(0)!=smOff || seq_getMode(1)!=smOff || arp_getMode()!=amOff)
-                    {
-                        if ((synth.clockBar==8 && currentPreset.steppedParameters[spLFOSync]==8) || synth.clockBar+1==currentPreset.steppedParameters[spLFOSync])
-                        {
-                            synth.clockBar=0;
-                            lfo_resetPhase(&synth.lfo);
-                        }
-                    }
-                }
-
-                // sequencer
-
-                if(seq_getMode(0)!=smOff || seq_getMode(1)!=smOff)
-                    seq_update();
-
-                // arpeggiator
-
-                if(arp_getMode()!=amOff)
-                    arp_update();
-            }
-        }
-
         // glide
 
         if(synth.gliding)
@@ -1595,9 +1689,14 @@ void synth_timerInterrupt(void)
         if(hz250)
         {
             scanner_update(hz63);
-            display_update(hz63);
-            if (hz63)
-                ui_update();
+
+            // keys are still scanned when shedding, display and UI wait
+            if(!shedding)
+            {
+                display_update(hz63);
+                if (hz63)
+                    ui_update();
+            }
         }
         break;
     }
@@ -1616,6 +1715,38 @@ void synth_timerInterrupt(void)
     }*/
 }
 
+void synth_timerOverrun(uint8_t missedTicks)
+{
+    if(synth.overrunCount<UINT16_MAX)
+        ++synth.overrunCount;
+    synth.missedTickCount=satAddU16U16(synth.missedTickCount,missedTicks);
+    synth.sheddingTicks=SYNTH_OVERRUN_SHEDDING_TICKS;
+}
+
+uint16_t synth_getOverrunCount(void)
+{
+    uint16_t v;
+
+    BLOCK_INT
+    {
+        v=synth.overrunCount;
+    }
+
+    return v;
+}
+
+uint16_t synth_getMissedTickCount(void)
+{
+    uint16_t v;
+
+    BLOCK_INT
+    {
+        v=synth.missedTickCount;
+    }
+
+    return v;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // P600 internal events
 ////////////////////////////////////////////////////////////////////////////////
@@ -1749,6 +1880,10 @@ void synth_assignerEvent(uint8_t note, int8_t gate, int8_t voice, uint16_t veloc
 
 void synth_uartEvent(uint8_t data)
 {
+    // timestamp MIDI clocks as soon as they are received, the parser runs in the interrupt at 500hz
+    if(data==MIDI_CLOCK && settings.syncMode==smMIDI)
+        clock_midiPulse();
+
     midi_newData(data);
 }
 
@@ -1759,7 +1894,6 @@ static void retuneLastNotePressed(int16_t bend, uint16_t modulation, uint8_t mas
     if (assigner_getLatestNotePressed(&note))
     {
         uint8_t scaleDegree = note % TUNER_NOTE_COUNT;
-        double numSemitones = scaleDegree;
 
         if(mask&1)
         {
@@ -1773,8 +1907,7 @@ static void retuneLastNotePressed(int16_t bend, uint16_t modulation, uint8_t mas
             // but currently it works like the pitch-wheel will in the future:
             // absolute adjusts +/- 1 semitone from Equal Tempered
 
-            numSemitones = (modulation * (1.0f / UINT16_MAX)) + (((double)scaleDegree)-0.5f);
-            tuner_setNoteTuning(scaleDegree, numSemitones);
+            tuner_setNoteTuningFromWheel(scaleDegree, modulation);
             computeTunedOffsetCVs();
             computeBenderCVs();
             computeTunedCVs(1,-1);
@@ -1816,7 +1949,7 @@ void synth_wheelEvent(int16_t bend, uint16_t modulation, uint8_t mask, int8_t is
             if (currentPreset.steppedParameters[spModwheelTarget]==1 && currentPreset.steppedParameters[spVibTarget]==1)
             {
                 // full strength for vib VCA modulation
-                synth.modwheelAmount=((uint16_t)((expf(((float)modulation)/30000.0f )-1.0f)*8310.08f));
+                synth.modwheelAmount=exponentialRise(modulation,EXPONENTIAL_COURSE_RATE(30000.0),8310);
 
             }
             else
@@ -1825,15 +1958,15 @@ void synth_wheelEvent(int16_t bend, uint16_t modulation, uint8_t mask, int8_t is
                 modBitShift=mr[currentPreset.steppedParameters[spModWheelRange]];
                 if (currentPreset.steppedParameters[spModWheelRange]<=1)
                 {
-                    synth.modwheelAmount=(((uint16_t)((expf(((float)modulation)/30000.0f )-1.0f)*8310.08f))>>modBitShift);
+                    synth.modwheelAmount=exponentialRise(modulation,EXPONENTIAL_COURSE_RATE(30000.0),8310)>>modBitShift;
                 }
                 else if(currentPreset.steppedParameters[spModWheelRange]==2)
                 {
-                    synth.modwheelAmount=(((uint16_t)((expf(((float)modulation)/17000.0f )-1.0f)*1417.6f))>>modBitShift);
+                    synth.modwheelAmount=exponentialRise(modulation,EXPONENTIAL_COURSE_RATE(17000.0),1418)>>modBitShift;
                 }
                 else
                 {
-                    synth.modwheelAmount=((uint16_t)((expf(((float)modulation)/14000.0f )-1.0f)*613.12f));
+                    synth.modwheelAmount=exponentialRise(modulation,EXPONENTIAL_COURSE_RATE(14000.0),613);
                 }
             }
             refreshLfoSettings();
@@ -1853,8 +1986,7 @@ void synth_realtimeEvent(uint8_t midiEvent)
 
     switch(midiEvent)
     {
-    case MIDI_CLOCK:
-        ++synth.pendingExtClock;
+    case MIDI_CLOCK: // see synth_uartEvent()
         break;
     case MIDI_START:
         seq_resetCounter(0,0);
@@ -22,6 +22,8 @@
 #define CSI1	0x0A	// Enables read switches and keyboard
 
 #define UART_USE_HW_INTERRUPT // this needs an additional wire that goes from pin C4 to pin E4
+//#define TIMER_ENVELOPE_SUBSTEP // half tick envelope updates, off until the tick timing is measured on hardware
+//#define TUNER_SUCCESSIVE_APPROXIMATION // autotune by the blind 14 probes search only, the baseline of host/tunebench
 
 #ifndef DEBUG
 	#ifdef RELEASE
@@ -43,6 +45,8 @@
 
 #define SYSEX_COMMAND_PATCH_DUMP 1
 #define SYSEX_COMMAND_PATCH_DUMP_REQUEST 2
+#define SYSEX_COMMAND_DIAGNOSTICS 3
+#define SYSEX_COMMAND_DIAGNOSTICS_REQUEST 4
 #define SYSEX_COMMAND_UPDATE_FW 0x6b
 
 #define SYSEX_SUBID1_BULK_TUNING_DUMP 0x08
@@ -142,6 +146,14 @@ void synth_update(void);
 void synth_timerInterrupt(void);
 void synth_uartInterrupt(void);
 
+// the timer interrupt ran past the next tick, missedTicks ticks were lost
+void synth_timerOverrun(uint8_t missedTicks);
+
+// optional, half way between two timer interrupts, when they leave enough headroom
+void synth_timerSubStep(void);
+uint16_t synth_getOverrunCount(void);
+uint16_t synth_getMissedTickCount(void);
+
 uint16_t mixer_volumeFromMixAndDrive(uint16_t mix, uint16_t drive);
 uint16_t mixer_mixFromVols(uint16_t volA, uint16_t volB);
 uint16_t mixer_driveFromVols(uint16_t volA, uint16_t volB);
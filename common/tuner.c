@@ -10,6 +10,8 @@
 #include "display.h"
 #include "storage.h"
 #include "scanner.h"
+#include "assigner.h"
+#include "midi.h"
 
 #define FF_P	0x01 // active low
 #define CNTR_EN 0x02
@@ -17,28 +19,58 @@
 #define FF_CL	0x10 // active low
 
 #define STATUS_TIMEOUT 1000000
+#define STATUS_TIMEOUT_BACKGROUND 50000 // the main loop can't be held for long
 #define STATUS_TIMEOUT_MAX_FAILURES 5
 
-#define TUNER_TICK 2000000.0
+#define TUNER_LOWEST_LOG2_PERIOD 1107570 // lowest C (261.63/16 Hz) in 2Mhz ticks, log2 in 16.16
 
-#define TUNER_MIDDLE_C_HERTZ 261.63
-#define TUNER_LOWEST_HERTZ (TUNER_MIDDLE_C_HERTZ/16)
-
-#define TUNER_OSC_INIT_OFFSET 5000.0
-#define TUNER_OSC_INIT_SCALE (65536.0/10.66)
+#define TUNER_OSC_INIT_OFFSET 5000L
+#define TUNER_OSC_INIT_SCALE 6148L // CV per octave, 65536/10.66
 #define TUNER_OSC_PRECISION -3 // higher is preciser but slower
-#define TUNER_OSC_NTH_C_LO 3
-#define TUNER_OSC_NTH_C_HI 6
 
-#define TUNER_FIL_INIT_OFFSET 10000.0
-#define TUNER_FIL_INIT_SCALE (65536.0/21.0)
+#define TUNER_FIL_INIT_OFFSET 10000L
+#define TUNER_FIL_INIT_SCALE 3121L // 65536/21
 #define TUNER_FIL_PRECISION -3 // higher is preciser but slower
-#define TUNER_FIL_NTH_C_LO 4
-#define TUNER_FIL_NTH_C_HI 7
+
+#define TUNER_DAC_STEP 4 // 14bit dac on 16bit CVs
+#define TUNER_COARSE_STEP (64*TUNER_DAC_STEP) // corrections above this are measured on less periods
+#define TUNER_MAX_PROBES 8 // secant refinement gives up after this, see tuneOffset
+
+#define TUNER_BG_START_TICKS (5*TICKER_1S) // after enabling, before the first voice is reserved
+#define TUNER_BG_INTERVAL_TICKS (60*TICKER_1S) // between two retuned voices
+#define TUNER_BG_SETTLE_TICKS 20 // after each CV change, before measuring
+#define TUNER_BG_LOCKED_CVS (((uint32_t)1<<pcMVol)|((uint32_t)1<<pcVolA)|((uint32_t)1<<pcVolB)| \
+	((uint32_t)1<<pcResonance)|((uint32_t)1<<pcExtFil)|((uint32_t)1<<pcPModOscB))
+
+struct search_s
+{
+	p600CV_t cv;
+	int8_t relPrec,probes;
+	uint16_t lowestCV,estimate;
+	int32_t x,prevX,scale,slope,step; // CVs, slope in CV per octave
+	int32_t prevL,tgtL; // log2 of periods, 16.16
+};
 
 static struct
 {
 	p600CV_t currentCV;
+	uint16_t probeCount;
+	
+	// background retune, see tuner_backgroundUpdate
+	
+	int8_t bgEnabled;
+	volatile int8_t bgVoice; // -1: none, a full tune can reset it from the interrupt
+	volatile int8_t bgPaused; // voice reserved, but the other voices sound
+	int8_t bgNextVoice;
+	int8_t bgCVType; // 0: osc A, 1: osc B, 2: filter
+	uint8_t bgOctave;
+	uint8_t bgPeriods;
+	int32_t bgDrift;
+	uint32_t bgStartTick; // earliest start of the next voice
+	uint32_t bgTick; // last CV change
+	uint8_t bgMidiCount; // midi_getInputCount() when the probe started
+	uint16_t bgTunes[TUNER_OCTAVE_COUNT];
+	struct search_s bgSearch;
 } tuner;
 
 static LOWERCODESIZE void whileTuning(void)
@@ -57,28 +89,51 @@ static LOWERCODESIZE void whileTuning(void)
 	sh_update();
 }
 
+// bus accesses are atomic, background tuning runs with interrupts on
+
 static void i8253Write(uint8_t a,uint8_t v)
 {
-	io_write(a,v);
+	BLOCK_INT
+	{
+		io_write(a,v);
+	}
 	CYCLE_WAIT(4);
 }	
 
 static uint8_t i8253Read(uint8_t a)
 {
+	uint8_t v;
+
 	CYCLE_WAIT(4);
-	return io_read(a);
+	BLOCK_INT
+	{
+		v=io_read(a);
+	}
+	return v;
 }
 
 static uint8_t ff_state=0;
 static uint8_t ff_step=0;
 static uint8_t ff_timeoutCount=0;
+static uint32_t ff_timeout=STATUS_TIMEOUT;
+static int8_t ff_background=0;
+
+// background probes give way to any MIDI input, it might be a note, it gets
+// parsed by the interrupt while pcMVol is still locked at 0
+static int8_t bgMidiReceived(void)
+{
+	return midi_getInputCount()!=tuner.bgMidiCount;
+}
 	
 static NOINLINE void ffMask(uint8_t set,uint8_t clear)
 {
 	ff_state|=set;
 	ff_state&=~clear;
 	
-	io_write(CS06,ff_state);
+	BLOCK_INT
+	{
+		io_write(CS06,ff_state);
+	}
 	CYCLE_WAIT(4);
 	
 	++ff_step;
@@ -101,12 +156,15 @@ static NOINLINE void ffDoTimeout(void)
 static void ffWaitStatus(uint8_t status)
 {
 	uint8_t s;
-	uint32_t timeout=STATUS_TIMEOUT;
+	uint32_t timeout=ff_timeout;
 
 	do{
-		s=io_read(CSI0);
+		BLOCK_INT
+		{
+			s=io_read(CSI0);
+		}
 		--timeout;
-	}while(((s>>1)&0x01)!=status && timeout);
+	}while(((s>>1)&0x01)!=status && timeout && !(ff_background && bgMidiReceived()));
 
 	if (!timeout)
 		ffDoTimeout();
@@ -115,12 +173,15 @@ static void ffWaitStatus(uint8_t status)
 static void ffWaitCounter(uint8_t status)
 {
 	uint8_t s;
-	uint32_t timeout=STATUS_TIMEOUT;
+	uint32_t timeout=ff_timeout;
 
 	do{
-		s=io_read(CSI0);
+		BLOCK_INT
+		{
+			s=io_read(CSI0);
+		}
 		--timeout;
-	}while(((s>>2)&0x01)!=status && timeout);
+	}while(((s>>2)&0x01)!=status && timeout && !(ff_background && bgMidiReceived()));
 
 	if (!timeout)
 		ffDoTimeout();
@@ -145,15 +206,12 @@ static NOINLINE uint16_t getPeriod(void)
 	return UINT16_MAX-c;
 }
 
-static NOINLINE uint32_t measureAudioPeriod(uint8_t periods) // in 2Mhz ticks
+static NOINLINE uint32_t countPeriods(uint8_t periods, int8_t background) // in 2Mhz ticks
 {
 	uint32_t res=0;
 	
-	// display / start maintainting CVs
+	ff_background=background;
 	
-	for(int8_t i=0;i<25;++i) // lower this and eg. filter tuning starts behaving badly
-		whileTuning();
-			
 	// prepare flip flop
 	
 	ff_state=0;
@@ -197,7 +255,10 @@ static NOINLINE uint32_t measureAudioPeriod(uint8_t periods) // in 2Mhz ticks
 
 		res+=getPeriod();
 
-		whileTuning();
+		if(!background)
+			whileTuning();
+		else if(tuner.bgVoice<0 || assigner_getAnyAssigned() || bgMidiReceived()) // preempted by a full tune or a note
+			break;
 
 		// detect untunable osc		
 		
@@ -211,65 +272,193 @@ static NOINLINE uint32_t measureAudioPeriod(uint8_t periods) // in 2Mhz ticks
 	return res;
 }
 
-static LOWERCODESIZE int8_t tuneOffset(p600CV_t cv,uint8_t nthC, uint8_t lowestNote, int8_t precision)
+static NOINLINE uint32_t measureAudioPeriod(uint8_t periods) // in 2Mhz ticks
 {
-	int8_t i,relPrec;
-	uint16_t estimate,bit;
-	double p,tgtp;
-	uint32_t ip;
+	// display / start maintainting CVs
+	
+	for(int8_t i=0;i<25;++i) // lower this and eg. filter tuning starts behaving badly
+		whileTuning();
+			
+	return countPeriods(periods,0);
+}
 
-	ff_timeoutCount=0;
+static LOWERCODESIZE int8_t approximateOffset(p600CV_t cv, uint16_t lowestCV, int32_t tgtL, int8_t relPrec, uint16_t * estimate)
+{
+	int8_t i;
+	uint16_t bit;
+	int32_t l;
+	uint32_t ip;
 
-	tgtp=TUNER_TICK/(TUNER_LOWEST_HERTZ*pow(2.0,nthC));
-	
-	estimate=UINT16_MAX;
+	*estimate=UINT16_MAX;
 	bit=0x8000;
 	
-	relPrec=precision+nthC;
-	
 	for(i=0;i<14;++i) // 14bit dac
 	{
-		if(estimate>tuner_computeCVFromNote(lowestNote,0,cv))
+		if(*estimate>lowestCV)
 		{
-			sh_setCV(cv,estimate,0);
+			sh_setCV(cv,*estimate,0);
 			
 			ip=measureAudioPeriod(1<<relPrec);
 			if(ip==UINT32_MAX)
 				return -1; // failure (untunable osc)
 			
-			p=(double)ip*pow(2.0,-relPrec);
+			++tuner.probeCount;
+			l=log2U32(ip)-((int32_t)relPrec<<16);
 		}
 		else
 		{
-			p=DBL_MAX;
+			l=INT32_MAX;
 		}
 		
 		// adjust estimate
-		if (p>tgtp)
-			estimate+=bit;
+		if (l>tgtL)
+			*estimate+=bit;
 		else
-			estimate-=bit;
+			*estimate-=bit;
 
 		// on to finer changes
 		bit>>=1;
 		
 	}
+	
+	return 0;
+}
 
-	settings.tunes[nthC][cv]=estimate;
+static LOWERCODESIZE void searchStart(struct search_s * s, p600CV_t cv, uint8_t nthC, uint8_t lowestNote, int8_t precision, int32_t drift)
+{
+	s->cv=cv;
+	s->tgtL=TUNER_LOWEST_LOG2_PERIOD-((int32_t)nthC<<16);
+	s->lowestCV=tuner_computeCVFromNote(lowestNote,0,cv);
+	s->relPrec=precision+nthC;
+	s->probes=0;
+	
+	// seed from the previous calibration, moved by the drift found on the octave below,
+	// unless it is more than an octave away from the theoretical tuning
+	
+	if(cv<pcFil1)
+	{
+		s->scale=TUNER_OSC_INIT_SCALE;
+		s->x=TUNER_OSC_INIT_OFFSET+nthC*TUNER_OSC_INIT_SCALE;
+	}
+	else
+	{
+		s->scale=TUNER_FIL_INIT_SCALE;
+		s->x=TUNER_FIL_INIT_OFFSET+nthC*TUNER_FIL_INIT_SCALE;
+	}
+	
+	s->prevX=(int32_t)settings.tunes[nthC][cv]+drift;
+	if(labs(s->prevX-s->x)<s->scale)
+		s->x=s->prevX;
+	
+	// secant refinement, log of the period is about linear with the CV
+	
+	s->slope=s->scale;
+	s->step=INT32_MAX;
+	s->prevL=0;
+}
+
+// sets s->estimate to the next CV to measure, returns how many periods to measure
+static LOWERCODESIZE uint8_t searchNextProbe(struct search_s * s)
+{
+	s->x=MAX(s->x,(int32_t)s->lowestCV+1);
+	s->estimate=MIN(s->x,UINT16_MAX);
+	
+	return 1<<((labs(s->step)>TUNER_COARSE_STEP)?MAX(s->relPrec-2,0):s->relPrec);
+}
+
+// 1: s->estimate is tuned, 0: needs another probe, -1: not converging
+static LOWERCODESIZE int8_t searchUpdate(struct search_s * s, uint32_t ip, uint8_t periods)
+{
+	int32_t l;
+	int64_t d;
+
+	++s->probes;
+	l=log2U32(ip)-log2U32(periods); // periods is a power of 2, so that is exact
+	
+	if(s->probes>1 && labs(s->estimate-s->prevX)>=TUNER_DAC_STEP && l!=s->prevL)
+		s->slope=MIN(MAX(((int64_t)(s->estimate-s->prevX)<<16)/(s->prevL-l),s->scale/2),2*s->scale);
+
+	// the correction is compared truncated but applied floored, as when it was a double
+	d=(int64_t)s->slope*(l-s->tgtL);
+	s->step=d/65536;
+	s->x=s->estimate+(int32_t)(d>>16);
+	s->prevX=s->estimate;
+	s->prevL=l;
+	
+	// done when the correction is below the dac resolution
+	if(labs(s->step)<TUNER_DAC_STEP && periods==(1<<s->relPrec))
+	{
+		searchNextProbe(s);
+		return 1;
+	}
+	
+	return (s->probes>=TUNER_MAX_PROBES)?-1:0;
+}
+
+static LOWERCODESIZE int8_t tuneOffset(p600CV_t cv,uint8_t nthC, uint8_t lowestNote, int8_t precision, int32_t * drift)
+{
+	int8_t res;
+#ifndef TUNER_SUCCESSIVE_APPROXIMATION
+	uint8_t periods;
+	uint32_t ip;
+#endif
+	struct search_s s;
+
+	ff_timeoutCount=0;
+
+	searchStart(&s,cv,nthC,lowestNote,precision,*drift);
+	
+#ifdef TUNER_SUCCESSIVE_APPROXIMATION
+	res=-1; // straight to the blind search
+#else
+	do
+	{
+		periods=searchNextProbe(&s);
+		sh_setCV(cv,s.estimate,0);
+		
+		ip=measureAudioPeriod(periods);
+		if(ip==UINT32_MAX)
+			return -1; // failure (untunable osc)
+
+		++tuner.probeCount;
+		res=searchUpdate(&s,ip,periods);
+	}
+	while(!res);
+#endif
+	
+	if(res<0 && approximateOffset(cv,s.lowestCV,s.tgtL,s.relPrec,&s.estimate)) // not converging, back to the blind search
+		return -1;
+
+	*drift=(int32_t)s.estimate-settings.tunes[nthC][cv];
+	settings.tunes[nthC][cv]=s.estimate;
 
 #ifdef DEBUG		
 	print("cv ");
-	phex16(estimate);
-	print(" per ");
-	phex16(p);
+	phex16(s.estimate);
+	print(" probes ");
+	phex(s.probes);
+	print(" log2 per ");
+	phex16(s.prevL>>8);
 	print(" ");
-	phex16(tgtp);
+	phex16(s.tgtL>>8);
 	print("\n");
 #endif
 	
 	return 0;
 }
 
+// for octaves that aren't directly tunable
+static void extrapolateOctaves(p600CV_t cv, int8_t lo, int8_t hi)
+{
+	int8_t i;
+	
+	for(i=lo-1;i>=0;--i)
+		settings.tunes[i][cv]=(uint32_t)2*settings.tunes[i+1][cv]-settings.tunes[i+2][cv];
+
+	for(i=hi+1;i<TUNER_OCTAVE_COUNT;++i)
+		settings.tunes[i][cv]=(uint32_t)2*settings.tunes[i-1][cv]-settings.tunes[i-2][cv];
+}
+
 void tuner_setNoteTuning(uint8_t note, double numSemitones)
 {
 	if (note >= TUNER_NOTE_COUNT) {
@@ -284,12 +473,26 @@ void tuner_setNoteTuning(uint8_t note, double numSemitones)
 	currentPreset.perNoteTuning[note] = numSemitones * TUNING_UNITS_PER_SEMITONE;
 }
 
+void tuner_setNoteTuningFromWheel(uint8_t note, uint16_t modulation)
+{
+	int32_t x;
+
+	// runs from synth_update, so fixed point: tuner_setNoteTuning(note,note-0.5+modulation/65536.0)
+	if (note >= TUNER_NOTE_COUNT)
+		return;
+
+	x=((int32_t)note<<16)+modulation-32768; // semitones, 16.16
+	x=MIN(MAX(x,0),(int32_t)12<<16);
+	currentPreset.perNoteTuning[note]=MIN(x/12,UINT16_MAX); // TUNING_UNITS_PER_SEMITONE is 65536/12
+}
+
 static LOWERCODESIZE void tuneCV(p600CV_t oscCV, p600CV_t ampCV)
 {
 #ifdef DEBUG		
 	print("\ntuning ");phex(oscCV);print("\n");
 #endif
 	int8_t isOsc,i;
+	int32_t drift=0;
 	
 	// init
 	
@@ -305,28 +508,18 @@ static LOWERCODESIZE void tuneCV(p600CV_t oscCV, p600CV_t ampCV)
 	if (isOsc)
 	{
 		for(i=TUNER_OSC_NTH_C_LO;i<=TUNER_OSC_NTH_C_HI;++i)
-			if (tuneOffset(oscCV,i,12*(TUNER_OSC_NTH_C_LO-2),TUNER_OSC_PRECISION))
+			if (tuneOffset(oscCV,i,12*(TUNER_OSC_NTH_C_LO-2),TUNER_OSC_PRECISION,&drift))
 				break;
 
-		// extrapolate for octaves that aren't directly tunable
-		
-		for(i=TUNER_OSC_NTH_C_LO-1;i>=0;--i)
-			settings.tunes[i][oscCV]=(uint32_t)2*settings.tunes[i+1][oscCV]-settings.tunes[i+2][oscCV];
-
-		for(i=TUNER_OSC_NTH_C_HI+1;i<TUNER_OCTAVE_COUNT;++i)
-			settings.tunes[i][oscCV]=(uint32_t)2*settings.tunes[i-1][oscCV]-settings.tunes[i-2][oscCV];
+		extrapolateOctaves(oscCV,TUNER_OSC_NTH_C_LO,TUNER_OSC_NTH_C_HI);
 	}
 	else
 	{
 		for(i=TUNER_FIL_NTH_C_LO;i<=TUNER_FIL_NTH_C_HI;++i)
-			if (tuneOffset(oscCV,i,12*(TUNER_FIL_NTH_C_LO-1),TUNER_FIL_PRECISION))
+			if (tuneOffset(oscCV,i,12*(TUNER_FIL_NTH_C_LO-1),TUNER_FIL_PRECISION,&drift))
 				break;
 
-		for(i=TUNER_FIL_NTH_C_LO-1;i>=0;--i)
-			settings.tunes[i][oscCV]=(uint32_t)2*settings.tunes[i+1][oscCV]-settings.tunes[i+2][oscCV];
-
-		for(i=TUNER_FIL_NTH_C_HI+1;i<TUNER_OCTAVE_COUNT;++i)
-			settings.tunes[i][oscCV]=(uint32_t)2*settings.tunes[i-1][oscCV]-settings.tunes[i-2][oscCV];
+		extrapolateOctaves(oscCV,TUNER_FIL_NTH_C_LO,TUNER_FIL_NTH_C_HI);
 	}
 	
 	// close VCA
@@ -346,6 +539,16 @@ static uint16_t extapolateUpperOctavesTunes(uint8_t oct, p600CV_t cv)
 	return MIN(v,UINT16_MAX);
 }
 
+static void init8253(void)
+{
+		// ch 0, mode 0, access 2 bytes, binary count
+	i8253Write(0x3,0b00110000); 
+		// ch 1, mode 0, access 2 bytes, binary count
+	i8253Write(0x3,0b01110000); 
+		// ch 2, mode 1, access 2 bytes, binary count
+	i8253Write(0x3,0b10110010); 
+}
+
 LOWERCODESIZE static void prepareSynth(void)
 {
 	display_clear();
@@ -374,14 +577,7 @@ LOWERCODESIZE static void prepareSynth(void)
 	sh_setCV(pcPModOscB,0,0);
 	sh_setCV(pcExtFil,0,0);
 
-	// init 8253
-		// ch 0, mode 0, access 2 bytes, binary count
-	i8253Write(0x3,0b00110000); 
-		// ch 1, mode 0, access 2 bytes, binary count
-	i8253Write(0x3,0b01110000); 
-		// ch 2, mode 1, access 2 bytes, binary count
-	i8253Write(0x3,0b10110010); 
-
+	init8253();
 }
 
 uint16_t tuner_computeCVPerOct(uint8_t note, p600CV_t cv)
@@ -433,11 +629,24 @@ NOINLINE uint16_t tuner_computeCVFromNote(uint8_t note, uint8_t nextInterp, p600
 	return value;
 }
 
+static void stopBackground(void)
+{
+	BLOCK_INT
+	{
+		sh_lock(0,0);
+		tuner.bgVoice=-1;
+		tuner.bgPaused=0;
+	}
+	assigner_reserveVoice(-1);
+}
+
 LOWERCODESIZE void tuner_init(void)
 {
 	int8_t i,j;
 	
+	stopBackground();
 	memset(&tuner,0,sizeof(tuner));
+	tuner.bgVoice=-1;
 	
 	// theoretical base tuning
 	
@@ -454,11 +663,13 @@ LOWERCODESIZE void tuner_tuneSynth(void)
 {
 	int8_t i;
 	
+	stopBackground();
+	
 	BLOCK_INT
 	{
-		// reinit tuner
+		// previous tuning is kept, it seeds the new one
 		
-		tuner_init();
+		tuner.probeCount=0;
 		
 		// prepare synth for tuning
 		
@@ -526,9 +737,260 @@ LOWERCODESIZE void tuner_tuneSynth(void)
 		display_clear();
 		
 		settings_save();
+
+#ifdef DEBUG
+		print("tuning probes ");
+		phex16(tuner.probeCount);
+		print("\n");
+#endif
 	}
 }
 
+uint16_t tuner_getProbeCount(void)
+{
+	return tuner.probeCount;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Background retune: one voice at a time, the other voices stay playable
+////////////////////////////////////////////////////////////////////////////////
+
+// the tune input sees the summed audio, mixer / gates / resonance are global,
+// so they are held (locked in sh) for as long as a voice is measured, and a
+// measure only happens while the other voices are silent. In between, the
+// voice stays reserved and the search keeps its progress.
+
+static p600CV_t bgCV(void)
+{
+	if(tuner.bgCVType==0)
+		return pcOsc1A+tuner.bgVoice;
+	else if(tuner.bgCVType==1)
+		return pcOsc1B+tuner.bgVoice;
+	else
+		return pcFil1+tuner.bgVoice;
+}
+
+static void bgHold(void)
+{
+	int8_t t=tuner.bgCVType;
+	
+	BLOCK_INT
+	{
+		tuner.bgPaused=0;
+		sh_lock(0,0);
+
+		sh_setCV(pcMVol,0,SH_FLAG_IMMEDIATE);
+		sh_setCV(pcVolA,t==0?UINT16_MAX:0,SH_FLAG_IMMEDIATE);
+		sh_setCV(pcVolB,t==1?UINT16_MAX:0,SH_FLAG_IMMEDIATE);
+		sh_setCV(pcResonance,t==2?UINT16_MAX:0,SH_FLAG_IMMEDIATE);
+		sh_setCV(pcExtFil,0,SH_FLAG_IMMEDIATE);
+		sh_setCV(pcPModOscB,0,SH_FLAG_IMMEDIATE);
+		
+		sh_setGate(pgASaw,t==0);
+		sh_setGate(pgBSaw,t==1);
+		sh_setGate(pgATri,0);
+		sh_setGate(pgBTri,0);
+		sh_setGate(pgSync,0);
+		sh_setGate(pgPModFA,0);
+		sh_setGate(pgPModFil,0);
+
+		// the interrupt leaves that voice alone, see tuner_getBackgroundVoice
+		
+		sh_setCV(pcAmp1+tuner.bgVoice,UINT16_MAX,SH_FLAG_IMMEDIATE);
+		if(t<2)
+			sh_setCV(pcFil1+tuner.bgVoice,UINT16_MAX,SH_FLAG_IMMEDIATE);
+		sh_setCV(bgCV(),tuner.bgSearch.estimate,SH_FLAG_IMMEDIATE);
+		
+		sh_lock(TUNER_BG_LOCKED_CVS,0xff);
+	}
+}
+
+static void bgPause(void)
+{
+	BLOCK_INT
+	{
+		// back to the interrupt, its envelopes are idle so it closes the VCA
+		sh_lock(0,0);
+		tuner.bgPaused=1;
+	}
+}
+
+static void bgStartOctave(void)
+{
+	if(tuner.bgCVType<2)
+		searchStart(&tuner.bgSearch,bgCV(),tuner.bgOctave,12*(TUNER_OSC_NTH_C_LO-2),TUNER_OSC_PRECISION,tuner.bgDrift);
+	else
+		searchStart(&tuner.bgSearch,bgCV(),tuner.bgOctave,12*(TUNER_FIL_NTH_C_LO-1),TUNER_FIL_PRECISION,tuner.bgDrift);
+
+	tuner.bgPeriods=searchNextProbe(&tuner.bgSearch);
+	tuner.bgTick=currentTick;
+}
+
+static void bgStartCV(void)
+{
+	tuner.bgOctave=(tuner.bgCVType<2)?TUNER_OSC_NTH_C_LO:TUNER_FIL_NTH_C_LO;
+	tuner.bgDrift=0;
+	bgStartOctave();
+}
+
+static int8_t bgStartVoice(void)
+{
+	int8_t i,v;
+	
+	for(i=0;i<SYNTH_VOICE_COUNT;++i)
+	{
+		v=(tuner.bgNextVoice+i)%SYNTH_VOICE_COUNT;
+		
+		// some other voice must be left to play, and that one must be free
+		if((settings.voiceMask&(1<<v)) && (settings.voiceMask&~(1<<v)) && !assigner_getAssignment(v,NULL))
+		{
+			tuner.bgNextVoice=(v+1)%SYNTH_VOICE_COUNT;
+			assigner_reserveVoice(v);
+			
+			tuner.bgPaused=1; // bgHold() once the others are silent
+			tuner.bgVoice=v;
+			tuner.bgCVType=0;
+			bgStartCV();
+			return 1;
+		}
+	}
+	
+	return 0;
+}
+
+LOWERCODESIZE int8_t tuner_backgroundUpdate(int8_t idle)
+{
+	struct search_s * s=&tuner.bgSearch;
+	p600CV_t cv;
+	uint32_t ip;
+	int8_t res,i,lo,hi;
+	
+	if(tuner.bgVoice<0)
+	{
+		if(!tuner.bgEnabled || (int32_t)(currentTick-tuner.bgStartTick)<0 || !bgStartVoice())
+			return 0;
+	}
+	
+	// disabling gives the voice back right away, old tuning is kept
+	
+	if(!tuner.bgEnabled)
+	{
+		stopBackground();
+		return 1;
+	}
+	
+	// the others play or MIDI came in, wait for a silence, the current probe will be redone
+	
+	if(!idle || bgMidiReceived())
+	{
+		tuner.bgMidiCount=midi_getInputCount();
+		
+		if(tuner.bgPaused)
+			return 0;
+
+		bgPause();
+		return 1;
+	}
+
+	if(tuner.bgPaused)
+		tuner.bgTick=currentTick;
+	
+	bgHold();
+
+	if(currentTick-tuner.bgTick<TUNER_BG_SETTLE_TICKS)
+		return 0;
+	
+	// one probe per call, a few ms
+	
+	init8253();
+	ff_timeoutCount=0;
+	ff_timeout=STATUS_TIMEOUT_BACKGROUND;
+	ip=countPeriods(tuner.bgPeriods,1);
+	ff_timeout=STATUS_TIMEOUT;
+	
+	if(tuner.bgVoice<0) // full tune happened meanwhile
+		return 1;
+	
+	if(assigner_getAnyAssigned() || bgMidiReceived()) // a note came from the interrupt, probe is lost
+	{
+		bgPause();
+		return 1;
+	}
+	
+	res=(ip==UINT32_MAX)?-1:searchUpdate(s,ip,tuner.bgPeriods);
+	
+	if(res<0) // untunable or not converging, leave it to a full tune
+	{
+		stopBackground();
+		tuner.bgStartTick=currentTick+TUNER_BG_INTERVAL_TICKS;
+		return 1;
+	}
+	
+	if(!res)
+	{
+		tuner.bgPeriods=searchNextProbe(s);
+		tuner.bgTick=currentTick;
+		return 0;
+	}
+	
+	// octave done
+
+	cv=bgCV();
+	tuner.bgTunes[tuner.bgOctave]=s->estimate;
+	tuner.bgDrift=(int32_t)s->estimate-settings.tunes[tuner.bgOctave][cv];
+	
+	lo=(tuner.bgCVType<2)?TUNER_OSC_NTH_C_LO:TUNER_FIL_NTH_C_LO;
+	hi=(tuner.bgCVType<2)?TUNER_OSC_NTH_C_HI:TUNER_FIL_NTH_C_HI;
+	
+	if(++tuner.bgOctave<=hi)
+	{
+		bgStartOctave();
+		return 0;
+	}
+	
+	// CV done, only now it replaces the previous tuning
+	
+	for(i=lo;i<=hi;++i)
+		settings.tunes[i][cv]=tuner.bgTunes[i];
+	extrapolateOctaves(cv,lo,hi);
+
+#ifdef DEBUG		
+	print("background tuned ");
+	phex(cv);
+	print("\n");
+#endif
+	
+	if(++tuner.bgCVType<=2)
+	{
+		bgStartCV();
+		return 0;
+	}
+	
+	// voice done
+	
+	stopBackground();
+	settings_save();
+	tuner.bgStartTick=currentTick+TUNER_BG_INTERVAL_TICKS;
+	
+	return 1;
+}
+
+int8_t tuner_getBackgroundVoice(void)
+{
+	return tuner.bgPaused?-1:tuner.bgVoice;
+}
+
+void tuner_setBackground(int8_t on)
+{
+	tuner.bgEnabled=on;
+	tuner.bgStartTick=currentTick+TUNER_BG_START_TICKS;
+}
+
+int8_t tuner_getBackground(void)
+{
+	return tuner.bgEnabled;
+}
+
 LOWERCODESIZE void tuner_scalingAdjustment(void)
 {
 	p600CV_t cv=0;
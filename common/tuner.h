@@ -6,12 +6,26 @@
 #define TUNER_CV_COUNT (pcFil6-pcOsc1A+1)
 #define TUNER_OCTAVE_COUNT 8 // changing this will break settings storage!
 #define TUNER_NOTE_COUNT 12 // currently we only store the 12-scale degrees
+
+// octaves measured by the tuner, the others are extrapolated
+#define TUNER_OSC_NTH_C_LO 3
+#define TUNER_OSC_NTH_C_HI 6
+#define TUNER_FIL_NTH_C_LO 4
+#define TUNER_FIL_NTH_C_HI 7
   
 uint16_t tuner_computeCVFromNote(uint8_t note, uint8_t nextInterp, p600CV_t cv);
 uint16_t tuner_computeCVPerOct(uint8_t note, p600CV_t cv);
 
 void tuner_init(void);
 void tuner_tuneSynth(void);
+uint16_t tuner_getProbeCount(void); // measures done by the last tuner_tuneSynth
+
+// background retune of one reserved voice at a time, measured while the others are silent
+int8_t tuner_backgroundUpdate(int8_t idle); // main loop, 1 -> synth state needs a refresh
+int8_t tuner_getBackgroundVoice(void); // -1 -> none or paused
+void tuner_setBackground(int8_t on);
+int8_t tuner_getBackground(void);
 void tuner_scalingAdjustment(void);
 void tuner_setNoteTuning(uint8_t note, double numSemitonesAboveFundamental);
+void tuner_setNoteTuningFromWheel(uint8_t note, uint16_t modulation); // +/- half a semitone from equal temperament
 #endif	/* TUNER_H */  
@@ -16,30 +16,28 @@ void uart_init(void)
 	CYCLE_WAIT(8);
 }
 
-void NOINLINE uart_send(uint8_t data)
+int8_t uart_trySend(uint8_t data)
 {
-		uint8_t status;
-
-	// wait until previous byte is transmitted
-
-	do
+	// status check and write are atomic, the interrupt sends realtime bytes too
+	BLOCK_INT
 	{
-		BLOCK_INT
-		{
-			status=mem_read(0xe000);
-		}
-		
+		if(!(mem_read(0xe000)&0x02))
+			return 0;
+
+		CYCLE_WAIT(4);
+		mem_write(0x6001,data);
 		CYCLE_WAIT(4);
 	}
-	while(!(status&0x02));
 
-	// send the new one
+	return 1;
+}
 
-	BLOCK_INT
-	{
-		mem_write(0x6001,data);
+void NOINLINE uart_send(uint8_t data)
+{
+	// wait until previous byte is transmitted
+
+	while(!uart_trySend(data))
 		CYCLE_WAIT(4);
-	}
 }
 
 void uart_update(void)
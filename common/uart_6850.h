@@ -5,6 +5,7 @@
 
 void uart_init(void);
 void uart_send(uint8_t data);
+int8_t uart_trySend(uint8_t data); // returns 0 when the transmitter is busy
 void uart_update(void);
 
 #endif	/* UART_6850_H */
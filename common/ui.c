@@ -10,6 +10,7 @@
 #include "display.h"
 #include "potmux.h"
 #include "midi.h"
+#include "clock.h"
 #include "stdio.h"
 
 const struct uiParam_s uiParameters[] =
@@ -168,10 +169,19 @@ static int8_t changeMiscSetting(p600Button_t button)
             currentPreset.contParamPotStatus[cpGlideVolB]=0;
             settings_save();
             return 0;
-        case pb7:
-            return 1;
-        case pb8: // sync mode
-            settings.syncMode=(settings.syncMode+1)%3;
+        case pb7: // background retune, not saved
+            tuner_setBackground(!tuner_getBackground());
+            return 0;
+        case pb8: // sync mode: internal, internal with MIDI clock out, MIDI, tape
+            if(settings.syncMode==smInternal && !settings.midiClockOut)
+            {
+                settings.midiClockOut=1;
+            }
+            else
+            {
+                settings.midiClockOut=0;
+                settings.syncMode=(settings.syncMode+1)%3;
+            }
             settings_save();
             refreshFullState();
             return 0;
@@ -212,10 +222,20 @@ static int8_t changeMiscSetting(p600Button_t button)
 	return 0;
 }
 
+static void appendJitter(char * s)
+{
+	uint16_t jitter=clock_getMidiJitter();
+
+	itoa(jitter/10,&s[strlen(s)],10);
+	strcat(s,".");
+	itoa(jitter%10,&s[strlen(s)],10);
+	strcat(s,"ms");
+}
+
 static LOWERCODESIZE void handleMiscAction(p600Button_t button)
 {
 	const char * chs[17]={"omni","ch1","ch2","ch3","ch4","ch5","ch6","ch7","ch8","ch9","ch10","ch11","ch12","ch13","ch14","ch15","ch16"};
-	char s[50];
+	char s[64];
 	int8_t nothingToDisplay=0;
 
 	if (button==ui.prevMiscButton ||
@@ -261,16 +281,40 @@ static LOWERCODESIZE void handleMiscAction(p600Button_t button)
 
 		sevenSeg_scrollText(s,1);
 		break;
-	case pb7: // that button doesn't work, simultaneous press with FromTape not possible
+	case pb7: // no simultaneous press with FromTape possible, only reachable by double click
+		if(tuner_getBackground())
+			sevenSeg_scrollText("Bg tune on",1);
+		else
+			sevenSeg_scrollText("Bg tune off",1);
 		break;
 	case pb8: // sync mode
 		switch(settings.syncMode)
 		{
 			case smInternal:
-				sevenSeg_scrollText("Int sync",1);
+				if(settings.midiClockOut)
+				{
+					strcpy(s,"Int sync clk out jit ");
+					appendJitter(s);
+					sevenSeg_scrollText(s,1);
+				}
+				else
+				{
+					sevenSeg_scrollText("Int sync",1);
+				}
 				break;
 			case smMIDI:
-				sevenSeg_scrollText("Midi sync",1);
+				strcpy(s,"Midi sync ");
+				if(clock_getMidiBPM())
+				{
+					itoa(clock_getMidiBPM()/10,&s[strlen(s)],10);
+					strcat(s," bpm jit ");
+					appendJitter(s);
+				}
+				else
+				{
+					strcat(s,"no clock");
+				}
+				sevenSeg_scrollText(s,1);
 				break;
 			case smTape:
 				sevenSeg_scrollText("tape sync",1);
@@ -307,6 +351,19 @@ static LOWERCODESIZE void handleMiscAction(p600Button_t button)
 	case pbSeq1: // reset settings an tune
 		sevenSeg_scrollText("again resets settings",1);
 		break;
+	case pbSeq2: // RAM and CPU telemetry
+		strcpy(s,"ram ");
+		itoa(hardware_getStaticRAM(),&s[strlen(s)],10);
+		strcat(s," stack ");
+		itoa(hardware_getStackUsage(),&s[strlen(s)],10);
+		strcat(s," free ");
+		itoa(hardware_getRAMFree(),&s[strlen(s)],10);
+		strcat(s," ovr ");
+		utoa(synth_getOverrunCount(),&s[strlen(s)],10);
+		strcat(s," lost ");
+		utoa(synth_getMissedTickCount(),&s[strlen(s)],10);
+		sevenSeg_scrollText(s,1);
+		break;
 	default:
 		break;
 	}
@@ -749,7 +806,7 @@ void LOWERCODESIZE ui_handleButton(p600Button_t button, int pressed)
         }
 	// Flat
     //  else if ((ui.isShifted || ui.isDoubleClicked) && ((button>=pb0 && button<=pb9) || button==pbTune || button==pbPreset || button==pbRecord))
-        else if ((ui.isShifted || ui.isDoubleClicked) && ((button>=pb0 && button<=pb9) || button==pbTune || button==pbPreset || button==pbRecord || button==pbSeq1))
+        else if ((ui.isShifted || ui.isDoubleClicked) && ((button>=pb0 && button<=pb9) || button==pbTune || button==pbPreset || button==pbRecord || button==pbSeq1 || button==pbSeq2))
 		// these are the special function buttons in shift mode
 		{
 			// Disable double click mode which might confuse
@@ -4,6 +4,65 @@
 
 #include "utils.h"
 
+#include <avr/pgmspace.h>
+
+// 65536*2^(-i/128), one octave, for exponentialCourse()
+static const PROGMEM uint16_t exp2Lookup[129]=
+{
+	65535,65182,64830,64480,64132,63785,63441,63098,62757,62419,62081,61746,
+	61413,61081,60751,60423,60097,59772,59449,59128,58809,58491,58176,57861,
+	57549,57238,56929,56622,56316,56012,55709,55408,55109,54811,54515,54221,
+	53928,53637,53347,53059,52773,52488,52204,51922,51642,51363,51085,50810,
+	50535,50262,49991,49721,49452,49185,48920,48655,48393,48131,47871,47613,
+	47356,47100,46846,46593,46341,46091,45842,45594,45348,45103,44859,44617,
+	44376,44137,43898,43661,43425,43191,42958,42726,42495,42265,42037,41810,
+	41584,41360,41136,40914,40693,40473,40255,40037,39821,39606,39392,39180,
+	38968,38757,38548,38340,38133,37927,37722,37518,37316,37114,36914,36715,
+	36516,36319,36123,35928,35734,35541,35349,35158,34968,34779,34591,34405,
+	34219,34034,33850,33667,33486,33305,33125,32946,32768
+};
+
+// feedback bits of 8 steps of the lfsr() register, from its top byte and the one below
+static const PROGMEM uint8_t lfsrFeedbackHi[256]=
+{
+	0x00,0xc5,0x8a,0x4f,0x14,0xd1,0x9e,0x5b,0x28,0xed,0xa2,0x67,0x3c,0xf9,0xb6,0x73,
+	0x50,0x95,0xda,0x1f,0x44,0x81,0xce,0x0b,0x78,0xbd,0xf2,0x37,0x6c,0xa9,0xe6,0x23,
+	0xa0,0x65,0x2a,0xef,0xb4,0x71,0x3e,0xfb,0x88,0x4d,0x02,0xc7,0x9c,0x59,0x16,0xd3,
+	0xf0,0x35,0x7a,0xbf,0xe4,0x21,0x6e,0xab,0xd8,0x1d,0x52,0x97,0xcc,0x09,0x46,0x83,
+	0x40,0x85,0xca,0x0f,0x54,0x91,0xde,0x1b,0x68,0xad,0xe2,0x27,0x7c,0xb9,0xf6,0x33,
+	0x10,0xd5,0x9a,0x5f,0x04,0xc1,0x8e,0x4b,0x38,0xfd,0xb2,0x77,0x2c,0xe9,0xa6,0x63,
+	0xe0,0x25,0x6a,0xaf,0xf4,0x31,0x7e,0xbb,0xc8,0x0d,0x42,0x87,0xdc,0x19,0x56,0x93,
+	0xb0,0x75,0x3a,0xff,0xa4,0x61,0x2e,0xeb,0x98,0x5d,0x12,0xd7,0x8c,0x49,0x06,0xc3,
+	0x80,0x45,0x0a,0xcf,0x94,0x51,0x1e,0xdb,0xa8,0x6d,0x22,0xe7,0xbc,0x79,0x36,0xf3,
+	0xd0,0x15,0x5a,0x9f,0xc4,0x01,0x4e,0x8b,0xf8,0x3d,0x72,0xb7,0xec,0x29,0x66,0xa3,
+	0x20,0xe5,0xaa,0x6f,0x34,0xf1,0xbe,0x7b,0x08,0xcd,0x82,0x47,0x1c,0xd9,0x96,0x53,
+	0x70,0xb5,0xfa,0x3f,0x64,0xa1,0xee,0x2b,0x58,0x9d,0xd2,0x17,0x4c,0x89,0xc6,0x03,
+	0xc0,0x05,0x4a,0x8f,0xd4,0x11,0x5e,0x9b,0xe8,0x2d,0x62,0xa7,0xfc,0x39,0x76,0xb3,
+	0x90,0x55,0x1a,0xdf,0x84,0x41,0x0e,0xcb,0xb8,0x7d,0x32,0xf7,0xac,0x69,0x26,0xe3,
+	0x60,0xa5,0xea,0x2f,0x74,0xb1,0xfe,0x3b,0x48,0x8d,0xc2,0x07,0x5c,0x99,0xd6,0x13,
+	0x30,0xf5,0xba,0x7f,0x24,0xe1,0xae,0x6b,0x18,0xdd,0x92,0x57,0x0c,0xc9,0x86,0x43
+};
+
+static const PROGMEM uint8_t lfsrFeedbackLo[256]=
+{
+	0x00,0x00,0x01,0x01,0x03,0x03,0x02,0x02,0x06,0x06,0x07,0x07,0x05,0x05,0x04,0x04,
+	0x0c,0x0c,0x0d,0x0d,0x0f,0x0f,0x0e,0x0e,0x0a,0x0a,0x0b,0x0b,0x09,0x09,0x08,0x08,
+	0x18,0x18,0x19,0x19,0x1b,0x1b,0x1a,0x1a,0x1e,0x1e,0x1f,0x1f,0x1d,0x1d,0x1c,0x1c,
+	0x14,0x14,0x15,0x15,0x17,0x17,0x16,0x16,0x12,0x12,0x13,0x13,0x11,0x11,0x10,0x10,
+	0x31,0x31,0x30,0x30,0x32,0x32,0x33,0x33,0x37,0x37,0x36,0x36,0x34,0x34,0x35,0x35,
+	0x3d,0x3d,0x3c,0x3c,0x3e,0x3e,0x3f,0x3f,0x3b,0x3b,0x3a,0x3a,0x38,0x38,0x39,0x39,
+	0x29,0x29,0x28,0x28,0x2a,0x2a,0x2b,0x2b,0x2f,0x2f,0x2e,0x2e,0x2c,0x2c,0x2d,0x2d,
+	0x25,0x25,0x24,0x24,0x26,0x26,0x27,0x27,0x23,0x23,0x22,0x22,0x20,0x20,0x21,0x21,
+	0x62,0x62,0x63,0x63,0x61,0x61,0x60,0x60,0x64,0x64,0x65,0x65,0x67,0x67,0x66,0x66,
+	0x6e,0x6e,0x6f,0x6f,0x6d,0x6d,0x6c,0x6c,0x68,0x68,0x69,0x69,0x6b,0x6b,0x6a,0x6a,
+	0x7a,0x7a,0x7b,0x7b,0x79,0x79,0x78,0x78,0x7c,0x7c,0x7d,0x7d,0x7f,0x7f,0x7e,0x7e,
+	0x76,0x76,0x77,0x77,0x75,0x75,0x74,0x74,0x70,0x70,0x71,0x71,0x73,0x73,0x72,0x72,
+	0x53,0x53,0x52,0x52,0x50,0x50,0x51,0x51,0x55,0x55,0x54,0x54,0x56,0x56,0x57,0x57,
+	0x5f,0x5f,0x5e,0x5e,0x5c,0x5c,0x5d,0x5d,0x59,0x59,0x58,0x58,0x5a,0x5a,0x5b,0x5b,
+	0x4b,0x4b,0x4a,0x4a,0x48,0x48,0x49,0x49,0x4d,0x4d,0x4c,0x4c,0x4e,0x4e,0x4f,0x4f,
+	0x47,0x47,0x46,0x46,0x44,0x44,0x45,0x45,0x41,0x41,0x40,0x40,0x42,0x42,0x43,0x43
+};
+
 inline uint16_t satAddU16U16(uint16_t a, uint16_t b)
 {
 	uint16_t r;
@@ -42,7 +101,7 @@ inline int32_t satAddS16S16(int16_t a, int16_t b)
 {
 	int32_t r;
 
-	r=a+b;
+	r=(int32_t)a+b; // int is 16 bits on the AVR
 	
 	//r=MAX(r,INT16_MIN);
 	//r=MIN(r,INT16_MAX);
@@ -55,7 +114,7 @@ inline uint16_t lerp(uint16_t a,uint16_t b,uint8_t x)
 	return a+(x*((b-a)>>8));
 }
 
-inline uint16_t computeShape(uint32_t phase, const uint16_t lookup[], int8_t interpolate)
+inline uint16_t computeShape_P(uint32_t phase, const uint16_t lookup[], int8_t interpolate)
 {
 	uint8_t ai,bi,x;
 	uint16_t a,b;
@@ -68,14 +127,14 @@ inline uint16_t computeShape(uint32_t phase, const uint16_t lookup[], int8_t int
 		if(ai<UINT8_MAX)
 			bi=ai+1;
 
-		a=lookup[ai];
-		b=lookup[bi];
+		a=pgm_read_word(&lookup[ai]);
+		b=pgm_read_word(&lookup[bi]);
 
 		return lerp(a,b,x);
 	}
 	else
 	{
-		return lookup[phase>>16];
+		return pgm_read_word(&lookup[phase>>16]);
 	}
 }
 
@@ -127,30 +186,106 @@ inline int16_t scaleU16S16(uint16_t a, int16_t b)
 
 inline int16_t scaleProportionalU16S16(uint16_t a, int16_t b)
 {
-	uint16_t r;
-    r=MIN((int32_t)(a*(1.0f + ((float)b)/65536.0f)),UINT16_MAX);
-	return r;
+	// a*(1+b/65536), without floats
+	return satAddU16S16(a,scaleU16S16(a,b));
 }
 
 
+static FORCEINLINE uint8_t lfsrFeedback(uint32_t v)
+{
+	return pgm_read_byte(&lfsrFeedbackHi[(uint8_t)(v>>24)])^pgm_read_byte(&lfsrFeedbackLo[(uint8_t)(v>>16)]);
+}
+
 inline uint32_t lfsr(uint32_t v, uint8_t taps)
 {
-	uint8_t b24;
-	
-	while(taps--)
+	// taps 32, 30, 26, 25, stepped a byte at a time, the remaining steps are
+	// the first bits of the next byte of feedback
+	while(taps>=8)
 	{
-		b24=v>>24;
-		
-		v<<=1;
-		v|=((b24>>7)^(b24>>5)^(b24>>1)^b24)&1;
+		v=(v<<8)|lfsrFeedback(v);
+		taps-=8;
 	}
-	
+
+	if(taps)
+		v=(v<<taps)|(lfsrFeedback(v)>>(8-taps));
+
 	return v;
 }
 
-uint16_t exponentialCourse(uint16_t v, float ratio, float range)
+uint16_t exponentialCourse(uint16_t v, uint16_t rate, uint16_t range)
+{
+	uint32_t octaves;
+	uint16_t a,b,x;
+	uint8_t i;
+
+	// range*2^-octaves, octaves in 4.28 fixed point
+
+	octaves=(uint32_t)v*rate;
+	i=(octaves>>21)&127;
+	x=(octaves>>9)&0xfff;
+
+	a=pgm_read_word(&exp2Lookup[i]);
+	b=pgm_read_word(&exp2Lookup[i+1]);
+	a-=((uint32_t)(a-b)*x+2048)>>12;
+
+	return ((uint32_t)range*a)>>(16+(octaves>>28));
+}
+
+uint16_t exponentialRise(uint16_t v, uint16_t rate, uint16_t scale)
+{
+	uint32_t octaves,t;
+	uint16_t a,b,x;
+	uint8_t i;
+
+	// scale*(2^octaves-1), octaves in 4.28 fixed point, the table read
+	// backwards gives 32768*2^fraction
+
+	octaves=(uint32_t)v*rate;
+	i=(octaves>>21)&127;
+	x=(octaves>>9)&0xfff;
+
+	a=pgm_read_word(&exp2Lookup[128-i]);
+	b=pgm_read_word(&exp2Lookup[127-i]);
+	a+=((uint32_t)(b-a)*x+2048)>>12;
+
+	t=((uint32_t)a<<(octaves>>28))-32768;
+
+	// t<2^31, so neither half overflows
+	t=(t>>15)*scale+(((t&0x7fff)*scale)>>15);
+
+	return t>UINT16_MAX?UINT16_MAX:t;
+}
+
+uint32_t log2U32(uint32_t v)
 {
-	return expf(-(float)v/ratio)*range;
+	uint32_t r;
+	uint8_t i;
+
+	if(!v)
+		return 0;
+
+	// integer part from the top bit, v normalized to 1.31
+
+	r=(uint32_t)31<<16;
+	while(!(v&0x80000000))
+	{
+		v<<=1;
+		r-=(uint32_t)1<<16;
+	}
+
+	// one fraction bit per squaring: v*v is in [1,4) as 2.30, a result
+	// >=2 gives a 1 bit and is 1.31 again as it is
+
+	for(i=0;i<16;++i)
+	{
+		v=((uint64_t)v*v)>>32;
+		if(v&0x80000000)
+			r|=(uint32_t)0x8000>>i;
+		else
+			v<<=1;
+	}
+
+	return r;
 }
 
 
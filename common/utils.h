@@ -26,11 +26,19 @@ int16_t scaleU16S16(uint16_t a, int16_t b);
 int16_t scaleProportionalU16S16(uint16_t a, int16_t b);
 
 uint16_t lerp(uint16_t a,uint16_t b,uint8_t x);
-uint16_t computeShape(uint32_t phase, const uint16_t lookup[], int8_t interpolate);
+uint16_t computeShape_P(uint32_t phase, const uint16_t lookup[], int8_t interpolate); // lookup is in PROGMEM
 
 uint32_t lfsr(uint32_t v, uint8_t taps);
 
-uint16_t exponentialCourse(uint16_t v, float ratio, float range);
+// range*exp(-v/ratio), rate is EXPONENTIAL_COURSE_RATE(ratio), ratio>=6000
+#define EXPONENTIAL_COURSE_RATE(ratio) ((uint16_t)(268435456.0*M_LOG2E/(ratio)+0.5))
+uint16_t exponentialCourse(uint16_t v, uint16_t rate, uint16_t range);
+
+// scale*(exp(v/ratio)-1), saturated, rate is EXPONENTIAL_COURSE_RATE(ratio)
+uint16_t exponentialRise(uint16_t v, uint16_t rate, uint16_t scale);
+
+// log2(v) in 16.16 fixed point, 0 for v==0
+uint32_t log2U32(uint32_t v);
 
 int uint16Compare(const void * a,const void * b); // for qsort
 
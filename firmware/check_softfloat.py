@@ -0,0 +1,138 @@
+"""Fails if the soft-float library is reachable from the real-time entry points.
+
+Works on the fat LTO objects, built with -ffunction-sections so that every call
+between two functions has a relocation: builds the call graph from those, adds
+every function whose address is taken (callbacks) as a root, and walks it from
+the given roots, not descending into exempt functions.
+
+usage: python3 check_softfloat.py [--objdump avr-objdump] -r root... [-x exempt...] objects...
+"""
+
+import collections
+import optparse
+import re
+import subprocess
+import sys
+
+parser = optparse.OptionParser()
+parser.add_option('--objdump', dest='objdump', default='avr-objdump')
+parser.add_option('-r', '--root', dest='roots', action='append', default=[],
+                  help='real-time entry point', metavar='FUNC')
+parser.add_option('-x', '--exempt', dest='exempt', action='append', default=[],
+                  help='function allowed to use floats, not descended into', metavar='FUNC')
+parser.add_option('--call-relocs', dest='call_relocs', default='R_AVR_CALL,R_AVR_13_PCREL',
+                  help='relocation types of call and jump instructions')
+
+options, objects = parser.parse_args()
+call_relocs = set(options.call_relocs.split(','))
+
+# libgcc float arithmetic and conversions, and the libm functions
+FLOAT_SYMBOL = re.compile(r'^(__[a-z]+[sd]f[a-z0-9]*|(exp|log|log10|pow|sqrt|sin|cos|tan|atan|atan2|'
+                          r'floor|ceil|round|lround|fmod|ldexp|frexp)f?)$')
+
+SYMBOL_LINE = re.compile(r'^([0-9a-f]+) (.{7}) (\S+)\s+([0-9a-f]+) (\S+)$')
+RELOC_LINE = re.compile(r'^([0-9a-f]+) (\S+)\s+(\S+?)(([+-])0x([0-9a-f]+))?$')
+
+
+def objdump(flag, obj):
+    return subprocess.run([options.objdump, flag, obj], check=True, stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout.splitlines()
+
+
+def plain(name):
+    return name.split('.')[0]  # searchUpdate.isra.0 is searchUpdate
+
+
+functions = {}  # (obj, name) for statics, name for globals -> (obj, section, start, size)
+local = {}  # obj -> {name: key}
+calls = collections.defaultdict(set)
+address_taken = set()
+
+for obj in objects:
+    local[obj] = {}
+    for line in objdump('-t', obj):
+        m = SYMBOL_LINE.match(line)
+        if not m or 'F' not in m.group(2):
+            continue
+        name = m.group(5)
+        key = (obj, name) if 'l' in m.group(2) else name
+        functions[key] = (obj, m.group(3), int(m.group(1), 16), int(m.group(4), 16))
+        if 'l' in m.group(2):
+            local[obj][name] = key
+
+by_section = collections.defaultdict(list)
+for key, (obj, section, start, size) in functions.items():
+    by_section[obj, section].append((start, size, key))
+
+
+def containing(obj, section, offset):
+    for start, size, key in by_section[obj, section]:
+        if start <= offset < start + max(size, 1):
+            return key, offset == start
+    return None, False
+
+
+for obj in objects:
+    section = None
+    for line in objdump('-r', obj):
+        if line.startswith('RELOCATION RECORDS FOR ['):
+            section = line[len('RELOCATION RECORDS FOR ['):-2]
+            continue
+        m = RELOC_LINE.match(line)
+        if not m or section.startswith(('.debug', '.stab', '.gnu.lto', '.comment', '.eh_frame')):
+            continue
+        offset, kind, target = int(m.group(1), 16), m.group(2), m.group(3)
+        addend = int(m.group(6), 16) * (-1 if m.group(5) == '-' else 1) if m.group(4) else 0
+        if target.startswith('.'):
+            # section symbol, a static function, or a label inside one
+            if len(by_section[obj, target]) == 1:
+                key, entry = by_section[obj, target][0][2], True
+            else:
+                key, entry = containing(obj, target, addend)
+            if key is None:
+                continue
+        else:
+            key, entry = local[obj].get(target, target), True
+        caller, _ = containing(obj, section, offset)
+        if caller is not None and caller != key:
+            calls[caller].add(key)
+        if entry and kind not in call_relocs and (caller is None or caller != key):
+            address_taken.add(key)
+
+
+def name_of(key):
+    return key[1] if isinstance(key, tuple) else key
+
+
+roots = [key for key in functions if plain(name_of(key)) in options.roots]
+missing = set(options.roots) - set(plain(name_of(key)) for key in roots)
+if missing:
+    sys.exit('check_softfloat.py: no such root: ' + ' '.join(sorted(missing)))
+roots += sorted(address_taken - set(roots), key=name_of)
+
+parent = dict((key, None) for key in roots)
+queue = collections.deque(roots)
+found = []
+while queue:
+    key = queue.popleft()
+    name = name_of(key)
+    if FLOAT_SYMBOL.match(name):
+        found.append(key)
+        continue
+    if plain(name) in options.exempt:
+        continue
+    for callee in sorted(calls[key], key=name_of):
+        if callee not in parent:
+            parent[callee] = key
+            queue.append(callee)
+
+for key in found:
+    path = []
+    while key is not None:
+        path.append(name_of(key))
+        key = parent[key]
+    if path[-1] not in options.roots:
+        path.append('(address taken)')
+    print('soft-float: ' + ' <- '.join(path))
+
+sys.exit(1 if found else 0)
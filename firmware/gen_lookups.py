@@ -0,0 +1,56 @@
+"""Generates common/lfo_lookups.h, the LFO curve tables, so that they live in flash instead of being computed in RAM.
+
+usage: python3 gen_lookups.py [-o ../common/lfo_lookups.h]
+"""
+
+import math
+import optparse
+import os
+import struct
+
+parser = optparse.OptionParser()
+parser.add_option(
+    '-o',
+    '--output_file',
+    dest='output_file',
+    default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "common", "lfo_lookups.h"),
+    help='Write output file to FILE',
+    metavar='FILE')
+
+options, args = parser.parse_args()
+
+
+def f32(x):
+    return struct.unpack('f', struct.pack('f', x))[0]
+
+
+def sine(i):
+    # same float math as the former runtime computation in lfo_init()
+    x = f32(math.cos(f32((f32(i / f32(255.0)) + 1.0) * math.pi)))
+    return int(f32(f32(f32(x + 1.0) / 2.0) * 65535.0))
+
+
+def table(name, values):
+    out.append('const PROGMEM uint16_t %s[]=' % name)
+    out.append('{')
+    for i in range(0, len(values), 12):
+        out.append('\t' + ','.join(str(v) for v in values[i:i + 12]) + ',')
+    out.append('};')
+    out.append('')
+
+
+out = []
+out.append('// generated by firmware/gen_lookups.py, do not edit')
+out.append('')
+out.append('#ifndef LFO_LOOKUPS_H')
+out.append('#define LFO_LOOKUPS_H')
+out.append('')
+out.append('#include "synth.h"')
+out.append('')
+
+table('sineShape', [sine(i) for i in range(256)])
+
+out.append('#endif')
+
+with open(options.output_file, "wt", newline='\n') as f:
+    f.write('\n'.join(out) + '\n')
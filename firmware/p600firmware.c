@@ -24,6 +24,8 @@
 #define CPU_125kHz      0x07
 #define CPU_62kHz       0x08
 
+#define STACK_PAINT 0xc5
+
 #define MEMZONE		0		//	/MREQ = 0	/RFSH = 1	/IORQ = 1
 #define IOZONE		1		//	/MREQ = 1	/RFSH = 0	/IORQ = 0
 
@@ -181,6 +183,8 @@ static FORCEINLINE void hardware_init(int8_t ints)
 		TCCR0B |= (1 << CS01) | (1 << CS00);	//Timer 0 prescaler = 64
 		TIMSK0 |= (1 << OCIE0A); 				//Enable overflow interrupt for Timer0
 
+		TCCR3B |= (1 << CS31) | (1 << CS30);	//Timer 3 free running, same prescaler as Timer0, measures overruns
+
 #ifdef UART_USE_HW_INTERRUPT	
 		EIMSK |= (1 << INT4); 	// enable INT4
 //		EICRB  = 0x00;			// Low level on INT4 triggers the interrupt
@@ -211,6 +215,16 @@ void storage_read(uint32_t pageIdx, uint8_t *buf)
 		SPI_read_page(pageIdx, &buf[0]);
 }
 
+void storage_writeBytes(uint16_t address, uint8_t *buf, uint16_t size)
+{
+	SPI_write_bytes(address, buf, size);
+}
+
+void storage_readBytes(uint16_t address, uint8_t *buf, uint16_t size)
+{
+	SPI_read_bytes(address, buf, size);
+}
+
 #define NRWW_SECTION(sec) __attribute__((section (sec))) __attribute__((noinline)) __attribute__((optimize ("O1"))) __attribute__((used))
 
 void NRWW_SECTION(".bootspace") boot_program_page (uint32_t page, uint8_t *buf)
@@ -472,8 +486,55 @@ void __attribute__((section(".vectors"),naked,used)) __init(void)
 	);
 }
 
+// RAM telemetry, there is no heap, all RAM above the statics is stack
+
+extern uint8_t _end; // end of .bss
+extern uint8_t __stack; // RAMEND
+
+static uint8_t * stackLowest; // deepest stack byte touched so far
+
+static FORCEINLINE void paintStack(void)
+{
+	uint8_t * p;
+
+	for(p=&_end;p<(uint8_t *)SP;++p)
+		*p=STACK_PAINT;
+
+	stackLowest=(uint8_t *)SP;
+}
+
+static void scanStack(void)
+{
+	uint8_t * p=&_end;
+
+	// the first byte that isn't paint anymore is as deep as the stack went
+	while(p<stackLowest && *p==STACK_PAINT)
+		++p;
+
+	stackLowest=p;
+}
+
+uint16_t hardware_getStaticRAM(void)
+{
+	return &_end-(uint8_t *)RAMSTART;
+}
+
+uint16_t hardware_getStackUsage(void)
+{
+	return &__stack-stackLowest+1;
+}
+
+uint16_t hardware_getRAMFree(void)
+{
+	return stackLowest-&_end;
+}
+
 int main(void)
 {
+	uint8_t frc=0;
+
+	paintStack();
+
 	CPU_PRESCALE(CPU_16MHz);  
 
 #ifdef DEBUG
@@ -518,21 +579,104 @@ int main(void)
 	for(;;)
 	{
 		synth_update();
+
+		if(!++frc)
+			scanStack();
 	}
 }
 
+#define TIMER0_SLOT 125 // Timer 0 and Timer 3 counts per 2khz tick
+
+#ifdef TIMER_ENVELOPE_SUBSTEP
+
+#define TIMER0_HALF_SLOT 62 // envelope sub-step compare match
+#define TIMER0_SUBSTEP_HEADROOM 40 // a tick pass ending before this count leaves room for a sub-step
+
+static volatile uint8_t timerSubStep; // the next compare match is half way through the tick
+
+#endif
+
 ISR(TIMER0_COMPA_vect)
 {
+	uint16_t compare,elapsed;
+#ifdef TIMER_ENVELOPE_SUBSTEP
+	uint8_t late=0; // Timer 0 count at which this tick was due, see below
+	uint8_t count;
+#endif
+
 	// use nested interrupts, because we must still handle synth_uartInterrupt
 	// we need to ensure we won't try to recursively handle another synth_timerInterrupt!
 	
 	TIMSK0 &= ~(1 << OCIE0A); //Disable overflow interrupt for Timer0
+
+#ifdef TIMER_ENVELOPE_SUBSTEP
+	// CTC isn't double buffered, OCR0A can only be changed to a count Timer 0 hasn't reached yet
+
+	if(timerSubStep)
+	{
+		timerSubStep=0;
+
+		// entered late (nested UART interrupt, BLOCK_INT in the main loop): the
+		// tick compare match would be missed and Timer 0 would wrap, so the
+		// sub-step is skipped and the late tick runs right away, one count of margin.
+		// Once past the half slot compare match again, Timer 0 has already wrapped
+		// and the tick was due one count after that.
+		count=TCNT0;
+		if(TIFR0 & (1 << OCF0A))
+		{
+			late=TIMER0_SLOT-2*TIMER0_HALF_SLOT;
+			synth_timerOverrun(0);
+		}
+		else if(count>=TIMER0_SLOT-TIMER0_HALF_SLOT-2)
+		{
+			late=TIMER0_SLOT-TIMER0_HALF_SLOT;
+			synth_timerOverrun(0);
+		}
+		else
+		{
+			OCR0A=TIMER0_SLOT-TIMER0_HALF_SLOT-1; // rest of the tick
+			sei();
+
+			synth_timerSubStep();
+
+			cli();
+			if(TIFR0 & (1 << OCF0A))
+				synth_timerOverrun(0);
+			TIMSK0 |= (1 << OCIE0A);
+			return;
+		}
+	}
+
+	// Timer 0 wasn't cleared when a late tick was due, its slot ends one slot
+	// after that count, which keeps the ticks on the grid
+	OCR0A=late+TIMER0_SLOT-1;
+	compare=TCNT3-(TCNT0-late); // when the compare match that started this pass happened
+#else
+	compare=TCNT3-TCNT0; // when the compare match that started this pass happened
+#endif
 	TIFR0 |= 7; // Clear any pending interrupt
 	sei();
 
 	synth_timerInterrupt();
 
 	cli();
+
+	// the next compare match already happened: this pass overran its slot, the next one will be late,
+	// and the compare matches after it were lost
+	if(TIFR0 & (1 << OCF0A))
+	{
+		elapsed=(uint16_t)(TCNT3-compare)/TIMER0_SLOT;
+		synth_timerOverrun(elapsed>1 ? MIN(elapsed-1,UINT8_MAX) : 0);
+	}
+#ifdef TIMER_ENVELOPE_SUBSTEP
+	else if(TCNT0<TIMER0_SUBSTEP_HEADROOM)
+	{
+		// enough headroom: higher envelope rate
+		timerSubStep=1;
+		OCR0A=TIMER0_HALF_SLOT-1;
+	}
+#endif
+
 	TIMSK0 |= (1 << OCIE0A); //Re-enable overflow interrupt for Timer0
 }
 
@@ -173,6 +173,63 @@ void SPI_init(uint8_t ClockSpeed)
     SPI_PORT |= (1 << CS);				// Return slave select to high
 }
 
+// Writes size bytes to F-RAM, from any address
+
+/*FORCEINLINE*/ void SPI_write_bytes(uint16_t address, const unsigned char *data, uint16_t size)
+{
+	SPI_wren();
+
+    SPI_PORT &= ~(1 << CS);				// Drive slave select low
+
+	SPDR = WRITE_CMD;					// Write opcode SPI data register
+    while (!(SPSR & (1 << SPIF))) {		// Wait for transmission complete
+	}
+
+	SPDR = address >> 8;				// High byte to SPI data register
+    while (!(SPSR & (1 << SPIF))) {		// Wait for transmission complete
+	}
+
+	SPDR = address;						// Low byte to SPI data register
+    while (!(SPSR & (1 << SPIF))) {		// Wait for transmission complete
+	}
+
+	while (size--) {
+		SPDR = (uint8_t)(*data++); 		// Data byte to SPI data register
+		while (!(SPSR & (1 << SPIF))) {	// Wait for transmission complete
+		}
+	}
+
+    SPI_PORT |= (1 << CS);				// Return slave select to high
+}
+
+// Reads size bytes from F-RAM, from any address
+
+/*FORCEINLINE*/ void SPI_read_bytes(uint16_t address, unsigned char *data, uint16_t size)
+{
+    SPI_PORT &= ~(1 << CS);				// Drive slave select low
+
+	SPDR = READ_CMD;					// Write opcode SPI data register
+    while (!(SPSR & (1 << SPIF))) {		// Wait for transmission complete
+	}
+
+	SPDR = address >> 8;				// High byte to SPI data register
+    while (!(SPSR & (1 << SPIF))) {		// Wait for transmission complete
+	}
+
+	SPDR = address;						// Low byte to SPI data register
+    while (!(SPSR & (1 << SPIF))) {		// Wait for transmission complete
+	}
+
+	while (size--) {
+		SPDR = 0xFF;					// Dummy byte to SPI data register
+		while (!(SPSR & (1 << SPIF))) {	// Wait for transmission complete
+		}
+		*data++ = SPDR;					// Received value to data
+	}
+
+    SPI_PORT |= (1 << CS);				// Return slave select to high
+}
+
 // Test routines for F-RAM
 
 // Tests page write and read : Writes and read a page of values, and cheks for errors
@@ -28,6 +28,8 @@ void SPI_write(uint16_t address, uint8_t data);
 uint8_t SPI_read(uint16_t address);
 void SPI_write_page(uint16_t address, const unsigned char *data);
 void SPI_read_page(uint16_t address, unsigned char *data);
+void SPI_write_bytes(uint16_t address, const unsigned char *data, uint16_t size);
+void SPI_read_bytes(uint16_t address, unsigned char *data, uint16_t size);
 void SPI_test_page(void);
 void SPI_test(void);
 
@@ -0,0 +1,14 @@
+#ifndef FAKE_AVR_INTERRUPTS_H
+#define FAKE_AVR_INTERRUPTS_H
+
+#include <stdint.h>
+
+static uint8_t SREG = 0;
+
+static inline void cli(void) {
+}
+
+static inline void sei(void) {
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef FAKE_AVR_PGMSPACE_H
+#define FAKE_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// no separate program memory on the host
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define PGM_P const char *
+
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif
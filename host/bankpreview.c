@@ -0,0 +1,293 @@
+////////////////////////////////////////////////////////////////////////////////
+// Patch bank preview: imports a sysex bank (as dumped by the firmware) into
+// the simulated synth, plays a chord on every preset, and renders each one to
+// a WAV file through the virtual voice board, presets spread over threads
+////////////////////////////////////////////////////////////////////////////////
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "p600sim.h"
+#include "p600audio.h"
+#include "synth.h"
+#include "storage.h"
+
+#define TICK_HERTZ 2000
+#define UPDATE_TICKS 2 // main loop rate vs the 2khz interrupt, as in cvtrace.c
+#define SAMPLE_RATE 44100
+#define OUTPUT_GAIN 0.25f // headroom for the four voices of the chord
+
+#define CV_COUNT (pcBPW+1)
+#define PRESET_COUNT 100
+
+#define BUTTON_TICKS 200 // long enough for the debounce of the 63hz button scan
+#define SYSEX_BYTES_PER_TICK 4 // keeps the MIDI input queue from overflowing
+#define LOAD_TICKS 200
+#define HOLD_TICKS 3000
+#define RELEASE_TICKS 3000
+
+static const uint8_t chord[]={48,55,60,64}; // C3 G3 C4 E4
+
+struct change_s
+{
+	uint32_t tick;
+	int8_t cv; // P600SIM_TRACE_GATES for gates
+	uint16_t value;
+};
+
+struct preview_s
+{
+	int8_t number;
+	uint16_t cvs[CV_COUNT];
+	uint8_t gates;
+	struct change_s * changes;
+	uint32_t changeCount,capacity;
+};
+
+static struct preview_s previews[PRESET_COUNT];
+static int previewCount;
+static struct preview_s * recording;
+static uint32_t tick;
+
+static const char * outDir;
+static int threadCount;
+
+static void traceChange(int8_t cv, uint16_t value)
+{
+	struct preview_s * p=recording;
+
+	if(p->changeCount>=p->capacity)
+	{
+		p->capacity=p->capacity?p->capacity*2:4096;
+		p->changes=realloc(p->changes,p->capacity*sizeof(struct change_s));
+	}
+
+	p->changes[p->changeCount].tick=tick;
+	p->changes[p->changeCount].cv=cv;
+	p->changes[p->changeCount].value=value;
+	++p->changeCount;
+}
+
+static void run(uint32_t ticks)
+{
+	while(ticks--)
+	{
+		synth_timerInterrupt();
+
+		if(tick%UPDATE_TICKS==0)
+			synth_update();
+
+		++tick;
+	}
+}
+
+static void pressButton(p600Button_t button)
+{
+	p600sim_setKey(button,1);
+	run(BUTTON_TICKS);
+	p600sim_setKey(button,0);
+	run(BUTTON_TICKS);
+}
+
+static void sendMidi(uint8_t b0, uint8_t b1, uint8_t b2)
+{
+	synth_uartEvent(b0);
+	synth_uartEvent(b1);
+	if(b0<0xc0 || b0>=0xe0)
+		synth_uartEvent(b2);
+}
+
+static int importBank(const char * name)
+{
+	FILE * f;
+	int b,n=0;
+
+	if(!(f=fopen(name,"rb")))
+	{
+		perror(name);
+		return 0;
+	}
+
+	// patch management (From tape + Record), the mode where received presets are stored
+
+	p600sim_setKey(pbFromTape,1);
+	run(BUTTON_TICKS);
+	pressButton(pbRecord);
+	p600sim_setKey(pbFromTape,0);
+	run(BUTTON_TICKS);
+
+	while((b=fgetc(f))!=EOF)
+	{
+		synth_uartEvent(b);
+		if(!(++n%SYSEX_BYTES_PER_TICK))
+			run(1);
+	}
+	run(LOAD_TICKS);
+
+	fclose(f);
+
+	pressButton(pbRecord);
+	return 1;
+}
+
+static void recordPreview(int8_t number)
+{
+	struct preview_s * p=&previews[previewCount++];
+	int8_t i,cv;
+
+	p->number=number;
+
+	sendMidi(0xc0,number,0);
+	run(LOAD_TICKS);
+
+	for(cv=0;cv<CV_COUNT;++cv)
+		p->cvs[cv]=p600sim_getCV(cv);
+	p->gates=p600sim_getGates();
+
+	recording=p;
+	tick=0;
+	p600sim_setTrace(traceChange);
+
+	for(i=0;i<sizeof(chord);++i)
+		sendMidi(0x90,chord[i],100);
+	run(HOLD_TICKS);
+
+	for(i=0;i<sizeof(chord);++i)
+		sendMidi(0x80,chord[i],0);
+	run(RELEASE_TICKS);
+
+	p600sim_setTrace(NULL);
+}
+
+static void writeWav(const char * name, const float * samples, uint32_t count)
+{
+	FILE * f;
+	uint32_t i,v;
+	int16_t s;
+
+	if(!(f=fopen(name,"wb")))
+	{
+		perror(name);
+		return;
+	}
+
+	// RIFF header, 16 bits mono, little endian host assumed
+	fwrite("RIFF",1,4,f);
+	v=36+count*2; fwrite(&v,4,1,f);
+	fwrite("WAVEfmt ",1,8,f);
+	v=16; fwrite(&v,4,1,f);
+	v=1|(1<<16); fwrite(&v,4,1,f); // PCM, mono
+	v=SAMPLE_RATE; fwrite(&v,4,1,f);
+	v=SAMPLE_RATE*2; fwrite(&v,4,1,f);
+	v=2|(16<<16); fwrite(&v,4,1,f); // block align, bits
+	fwrite("data",1,4,f);
+	v=count*2; fwrite(&v,4,1,f);
+
+	for(i=0;i<count;++i)
+	{
+		s=samples[i]>1.0f?32767:samples[i]<-1.0f?-32767:samples[i]*32767.0f;
+		fwrite(&s,2,1,f);
+	}
+
+	fclose(f);
+}
+
+static void renderPreview(struct preview_s * p)
+{
+	struct p600audio_s audio;
+	float * samples;
+	uint32_t t,c=0,pos=0,next,count;
+	int8_t cv;
+	char name[1024];
+
+	count=(uint64_t)(HOLD_TICKS+RELEASE_TICKS)*SAMPLE_RATE/TICK_HERTZ;
+	samples=malloc(count*sizeof(float));
+
+	p600audio_init(&audio,SAMPLE_RATE);
+	for(cv=0;cv<CV_COUNT;++cv)
+		p600audio_setCV(&audio,cv,p->cvs[cv]);
+	p600audio_setGates(&audio,p->gates);
+
+	for(t=0;t<HOLD_TICKS+RELEASE_TICKS;++t)
+	{
+		for(;c<p->changeCount && p->changes[c].tick<=t;++c)
+			if(p->changes[c].cv==P600SIM_TRACE_GATES)
+				p600audio_setGates(&audio,p->changes[c].value);
+			else
+				p600audio_setCV(&audio,p->changes[c].cv,p->changes[c].value);
+
+		next=(uint64_t)(t+1)*SAMPLE_RATE/TICK_HERTZ;
+		p600audio_render(&audio,&samples[pos],next-pos);
+		pos=next;
+	}
+
+	for(pos=0;pos<count;++pos)
+		samples[pos]*=OUTPUT_GAIN;
+
+	snprintf(name,sizeof(name),"%s/preset%02d.wav",outDir,p->number);
+	writeWav(name,samples,count);
+
+	free(samples);
+}
+
+static void * renderThread(void * arg)
+{
+	int i;
+
+	for(i=(intptr_t)arg;i<previewCount;i+=threadCount)
+		renderPreview(&previews[i]);
+
+	return NULL;
+}
+
+int main(int argc, char ** argv)
+{
+	pthread_t threads[64];
+	int8_t n;
+	intptr_t i;
+
+	if(argc<3)
+	{
+		fprintf(stderr,"usage: %s bank.syx outdir [threads]\n",argv[0]);
+		return 2;
+	}
+
+	outDir=argv[2];
+	threadCount=argc>3?atoi(argv[3]):4;
+	if(threadCount<1)
+		threadCount=1;
+	if(threadCount>64)
+		threadCount=64;
+
+	p600sim_init(1);
+	p600sim_setDefaultPanel();
+	p600sim_bootSynth();
+
+	if(!importBank(argv[1]))
+		return 2;
+
+	if(!settings.presetMode)
+		pressButton(pbPreset);
+
+	for(n=0;n<PRESET_COUNT;++n)
+		if(preset_checkPage(n))
+			recordPreview(n);
+
+	if(!previewCount)
+	{
+		fprintf(stderr,"%s: no preset imported\n",argv[1]);
+		return 1;
+	}
+
+	// the firmware is single instance, only the audio runs in parallel
+
+	for(i=0;i<threadCount;++i)
+		pthread_create(&threads[i],NULL,renderThread,(void *)i);
+	for(i=0;i<threadCount;++i)
+		pthread_join(threads[i],NULL);
+
+	printf("%d presets rendered to %s\n",previewCount,outDir);
+	return 0;
+}
@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////
+// CV trace regression: plays a scripted scenario (MIDI bytes, keys, buttons,
+// pots) into the firmware, records every S&H output and gates latch change,
+// and either prints the trace or compares it to a golden one
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "p600sim.h"
+#include "synth.h"
+#include "scenario.h"
+
+#define MAX_TRACE (1024*1024)
+
+#define UPDATE_TICKS 2 // main loop rate vs the 2khz interrupt, about what the firmware does
+
+#define CV_COUNT (pcBPW+1)
+#define TRACE_STATE_SIZE (CV_COUNT+1) // CVs, then gates
+
+struct trace_s
+{
+	int32_t tick;
+	int8_t cv; // P600SIM_TRACE_GATES for gates
+	uint16_t value;
+};
+
+static struct scenarioEvent_s events[SCENARIO_MAX_EVENTS];
+static int eventCount;
+
+static struct trace_s trace[MAX_TRACE];
+static int traceCount;
+static int32_t traceTick;
+
+static void traceEvent(int8_t cv, uint16_t value)
+{
+	if(traceCount>=MAX_TRACE)
+	{
+		fprintf(stderr,"trace too long\n");
+		exit(2);
+	}
+
+	trace[traceCount].tick=traceTick;
+	trace[traceCount].cv=cv;
+	trace[traceCount].value=value;
+	++traceCount;
+}
+
+static void playEvent(struct scenarioEvent_s * e)
+{
+	int i;
+
+	switch(e->type)
+	{
+	case etMidi:
+		for(i=0;i<e->midiSize;++i)
+			synth_uartEvent(e->midi[i]);
+		break;
+	case etKey:
+		p600sim_setKey(e->index,e->value);
+		break;
+	case etPot:
+		p600sim_setPot(e->index,e->value);
+		break;
+	default:
+		break;
+	}
+}
+
+static void run(void)
+{
+	int i,next=0;
+	int32_t end=events[eventCount-1].tick;
+
+	p600sim_init(1);
+	p600sim_setDefaultPanel();
+
+	// pots at tick 0 are the panel at power on
+	for(i=0;i<eventCount && events[i].tick==0;++i)
+		if(events[i].type==etPot)
+			playEvent(&events[i]);
+
+	p600sim_bootSynth();
+
+	// initial state, then changes only
+
+	for(i=0;i<CV_COUNT;++i)
+		traceEvent(i,p600sim_getCV(i));
+	traceEvent(P600SIM_TRACE_GATES,p600sim_getGates());
+	p600sim_setTrace(traceEvent);
+
+	for(traceTick=0;traceTick<=end;++traceTick)
+	{
+		while(next<eventCount && events[next].tick<=traceTick)
+			playEvent(&events[next++]);
+
+		synth_timerInterrupt();
+
+		if(traceTick%UPDATE_TICKS==0)
+			synth_update();
+	}
+
+	p600sim_setTrace(NULL);
+}
+
+static void printTrace(void)
+{
+	int i;
+
+	for(i=0;i<traceCount;++i)
+		if(trace[i].cv==P600SIM_TRACE_GATES)
+			printf("%d gates %02x\n",trace[i].tick,trace[i].value);
+		else
+			printf("%d cv %d %u\n",trace[i].tick,trace[i].cv,trace[i].value);
+}
+
+static int loadGolden(const char * name, struct trace_s ** golden)
+{
+	FILE * f;
+	char line[64],type[16];
+	int tick,cv,value,count=0;
+
+	if(!(f=fopen(name,"r")))
+	{
+		perror(name);
+		return -1;
+	}
+
+	*golden=malloc(MAX_TRACE*sizeof(struct trace_s));
+
+	while(count<MAX_TRACE && fgets(line,sizeof(line),f))
+	{
+		if(sscanf(line,"%d %15s",&tick,type)!=2)
+			continue;
+
+		if(!strcmp(type,"gates") && sscanf(line,"%*d %*s %x",&value)==1)
+			cv=P600SIM_TRACE_GATES;
+		else if(!strcmp(type,"cv") && sscanf(line,"%*d %*s %d %d",&cv,&value)==2 && cv>=0 && cv<CV_COUNT)
+			;
+		else
+			continue;
+
+		(*golden)[count].tick=tick;
+		(*golden)[count].cv=cv;
+		(*golden)[count].value=value;
+		++count;
+	}
+
+	fclose(f);
+	return count;
+}
+
+static void applyTick(struct trace_s * t, int count, int * pos, uint16_t * state)
+{
+	int32_t tick=t[*pos].tick;
+
+	for(;*pos<count && t[*pos].tick==tick;++*pos)
+		state[t[*pos].cv==P600SIM_TRACE_GATES?CV_COUNT:t[*pos].cv]=t[*pos].value;
+}
+
+// compares CV and gates states at the end of each tick, CVs within tolerance, gates exactly
+static int compare(struct trace_s * golden, int goldenCount, int tolerance)
+{
+	uint16_t gs[TRACE_STATE_SIZE]={0},ts[TRACE_STATE_SIZE]={0};
+	int gp=0,tp=0,i,diff,maxDiff=0,errors=0;
+	int32_t tick;
+
+	while(gp<goldenCount || tp<traceCount)
+	{
+		if(tp>=traceCount || (gp<goldenCount && golden[gp].tick<trace[tp].tick))
+			tick=golden[gp].tick;
+		else
+			tick=trace[tp].tick;
+
+		if(gp<goldenCount && golden[gp].tick==tick)
+			applyTick(golden,goldenCount,&gp,gs);
+		if(tp<traceCount && trace[tp].tick==tick)
+			applyTick(trace,traceCount,&tp,ts);
+
+		for(i=0;i<TRACE_STATE_SIZE;++i)
+		{
+			diff=abs((int)gs[i]-(int)ts[i]);
+
+			if(i<CV_COUNT && diff>maxDiff)
+				maxDiff=diff;
+
+			if(i==CV_COUNT?diff!=0:diff>tolerance)
+			{
+				if(errors<10)
+				{
+					if(i==CV_COUNT)
+						printf("tick %d: gates %02x, golden %02x\n",tick,ts[i],gs[i]);
+					else
+						printf("tick %d: cv %d %u, golden %u\n",tick,i,ts[i],gs[i]);
+				}
+				++errors;
+			}
+		}
+	}
+
+	if(errors)
+		printf("%d mismatches, max CV difference %d\n",errors,maxDiff);
+
+	return errors==0;
+}
+
+int main(int argc, char ** argv)
+{
+	struct trace_s * golden;
+	int goldenCount,tolerance;
+
+	if(argc<2)
+	{
+		fprintf(stderr,"usage: %s scenario [golden [tolerance]]\n",argv[0]);
+		return 2;
+	}
+
+	if(!(eventCount=scenario_load(argv[1],events)))
+		return 2;
+
+	run();
+
+	if(argc<3)
+	{
+		printTrace();
+		return 0;
+	}
+
+	if((goldenCount=loadGolden(argv[2],&golden))<0)
+		return 2;
+
+	tolerance=argc>3?atoi(argv[3]):0;
+
+	if(!compare(golden,goldenCount,tolerance))
+	{
+		printf("%s: FAILED\n",argv[1]);
+		return 1;
+	}
+
+	printf("%s: ok, %d changes\n",argv[1],traceCount);
+	return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef HARDWARE_IMPL_H
+#define	HARDWARE_IMPL_H
+
+// host mockup, waits advance the simulated time instead (see p600sim.c)
+
+void p600sim_advance(double seconds);
+
+#define CYCLE_WAIT(cycles) p600sim_advance((cycles)*4/16000000.0);
+#define BLOCK_INT for(int8_t _blockInt=1;_blockInt;_blockInt=0)
+#define MDELAY(ms) p600sim_advance((ms)/1000.0)
+
+char * itoa(int value, char * s, int radix); // avr-libc has it in stdlib.h
+char * utoa(unsigned int value, char * s, int radix);
+
+#endif	/* HARDWARE_IMPL_H */
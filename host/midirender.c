@@ -0,0 +1,370 @@
+////////////////////////////////////////////////////////////////////////////////
+// Offline renderer: plays a Standard MIDI File into the firmware, as fast as
+// the host can run the 2khz interrupt, and writes a binary CV timeline
+//
+// Timeline file, little endian:
+//   header: "P6CV", version (u8), CV count (u8), ticks per second (u16)
+//   initial state: CV count x u16, gates (u8)
+//   then one record per change: ticks since the previous record (varint, 7 bits
+//   per byte, low bits first, bit 7 set when more bytes follow), index (u8,
+//   0-31 CVs in p600CV_t order so voice v has pcOsc1A+v,pcOsc1B+v,pcFil1+v,
+//   pcAmp1+v; 32 is the gates latch), value (u16)
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "p600sim.h"
+#include "synth.h"
+
+#define TICK_HERTZ 2000
+#define UPDATE_TICKS 2 // main loop rate vs the 2khz interrupt, as in cvtrace.c
+
+#define CV_COUNT (pcBPW+1)
+#define GATES_INDEX CV_COUNT
+#define TIMELINE_VERSION 1
+
+#define DEFAULT_TAIL 2.0 // seconds rendered after the last event, for the releases
+
+struct smfEvent_s
+{
+	uint32_t time; // in SMF ticks, then in 2khz ticks once the tempo map is applied
+	uint32_t order; // file order, keeps same time events stable when merging tracks
+	uint8_t status;
+	const uint8_t * data;
+	uint32_t size;
+};
+
+static struct
+{
+	struct smfEvent_s * events;
+	uint32_t count,capacity;
+	int16_t division;
+} smf;
+
+static FILE * out;
+static uint32_t tick,lastTick;
+static uint32_t changeCount,ampStarts[SYNTH_VOICE_COUNT];
+static uint16_t amps[SYNTH_VOICE_COUNT];
+
+static double cpuSeconds(void)
+{
+	struct timespec ts;
+
+	// not clock(), the firmware has a clock struct
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static uint32_t readBE(const uint8_t * p, int8_t size)
+{
+	uint32_t v=0;
+
+	while(size--)
+		v=(v<<8)|*p++;
+
+	return v;
+}
+
+static int readVarLen(const uint8_t ** p, const uint8_t * end, uint32_t * v)
+{
+	int8_t i;
+
+	*v=0;
+	for(i=0;i<4 && *p<end;++i)
+	{
+		*v=(*v<<7)|(**p&0x7f);
+		if(!(*(*p)++&0x80))
+			return 1;
+	}
+
+	return 0;
+}
+
+static void addEvent(uint32_t time, uint8_t status, const uint8_t * data, uint32_t size)
+{
+	struct smfEvent_s * e;
+
+	if(smf.count>=smf.capacity)
+	{
+		smf.capacity=smf.capacity?smf.capacity*2:1024;
+		smf.events=realloc(smf.events,smf.capacity*sizeof(struct smfEvent_s));
+	}
+
+	e=&smf.events[smf.count];
+	e->time=time;
+	e->order=smf.count;
+	e->status=status;
+	e->data=data;
+	e->size=size;
+	++smf.count;
+}
+
+static int parseTrack(const uint8_t * p, const uint8_t * end)
+{
+	uint32_t time=0,delta,size;
+	uint8_t status=0;
+	static const uint8_t dataSizes[8]={2,2,2,2,1,1,2,0}; // 0x8n to 0xEn
+
+	while(p<end)
+	{
+		if(!readVarLen(&p,end,&delta) || p>=end)
+			return 0;
+		time+=delta;
+
+		if(*p&0x80)
+			status=*p++;
+		else if(!status)
+			return 0; // running status without a status
+
+		if(status==0xff) // meta
+		{
+			if(p>=end)
+				return 0;
+			status=*p++; // meta type, stored with the 0x80 bit cleared
+			if(!readVarLen(&p,end,&size) || p+size>end)
+				return 0;
+			addEvent(time,status&0x7f,p,size);
+			p+=size;
+			status=0;
+		}
+		else if(status==0xf0 || status==0xf7) // sysex, escape
+		{
+			if(!readVarLen(&p,end,&size) || p+size>end)
+				return 0;
+			addEvent(time,status,p,size);
+			p+=size;
+			status=0;
+		}
+		else
+		{
+			size=dataSizes[(status>>4)&7];
+			if(p+size>end)
+				return 0;
+			addEvent(time,status,p,size);
+			p+=size;
+		}
+	}
+
+	return 1;
+}
+
+static int loadSMF(const char * name)
+{
+	FILE * f;
+	long size;
+	uint8_t * buf;
+	const uint8_t * p,* end;
+	uint32_t chunkSize;
+	int16_t tracks;
+
+	if(!(f=fopen(name,"rb")))
+	{
+		perror(name);
+		return 0;
+	}
+
+	fseek(f,0,SEEK_END);
+	size=ftell(f);
+	fseek(f,0,SEEK_SET);
+	buf=malloc(size);
+	if(fread(buf,1,size,f)!=(size_t)size)
+		size=0;
+	fclose(f);
+
+	if(size<14 || memcmp(buf,"MThd",4))
+	{
+		fprintf(stderr,"%s: not a MIDI file\n",name);
+		return 0;
+	}
+
+	tracks=readBE(buf+10,2);
+	smf.division=readBE(buf+12,2);
+	p=buf+8+readBE(buf+4,4);
+	end=buf+size;
+
+	for(;tracks && p+8<=end;p+=8+chunkSize)
+	{
+		chunkSize=readBE(p+4,4);
+		if(p+8+chunkSize>end)
+			break;
+
+		if(!memcmp(p,"MTrk",4))
+		{
+			if(!parseTrack(p+8,p+8+chunkSize))
+			{
+				fprintf(stderr,"%s: bad track\n",name);
+				return 0;
+			}
+			--tracks;
+		}
+	}
+
+	return 1;
+}
+
+static int compareEvents(const void * a, const void * b)
+{
+	const struct smfEvent_s * ea=a,* eb=b;
+
+	if(ea->time!=eb->time)
+		return ea->time<eb->time?-1:1;
+
+	return ea->order<eb->order?-1:1;
+}
+
+// merges the tracks, then converts SMF ticks to 2khz ticks along the tempo map
+static void applyTempoMap(void)
+{
+	uint32_t i,t,prev=0,tempo=500000; // us per quarter note, MIDI default
+	double seconds=0.0,secondsPerTick;
+
+	qsort(smf.events,smf.count,sizeof(struct smfEvent_s),compareEvents);
+
+	if(smf.division<0) // SMPTE: frames per second and ticks per frame
+		secondsPerTick=1.0/((-(smf.division>>8))*(smf.division&0xff));
+	else
+		secondsPerTick=tempo/1e6/smf.division;
+
+	for(i=0;i<smf.count;++i)
+	{
+		t=smf.events[i].time;
+		seconds+=(t-prev)*secondsPerTick;
+		prev=t;
+
+		smf.events[i].time=(uint32_t)(seconds*TICK_HERTZ+0.5);
+
+		if(smf.events[i].status==0x51 && smf.events[i].size==3 && smf.division>0)
+		{
+			tempo=readBE(smf.events[i].data,3);
+			secondsPerTick=tempo/1e6/smf.division;
+		}
+	}
+}
+
+static void playEvent(struct smfEvent_s * e)
+{
+	uint32_t i;
+
+	if(!(e->status&0x80))
+		return; // meta
+
+	if(e->status!=0xf7) // escaped sysex bytes go as they are
+		synth_uartEvent(e->status);
+
+	for(i=0;i<e->size;++i)
+		synth_uartEvent(e->data[i]);
+}
+
+static void writeU16(uint16_t v)
+{
+	fputc(v&0xff,out);
+	fputc(v>>8,out);
+}
+
+static void timelineEvent(int8_t cv, uint16_t value)
+{
+	uint32_t delta=tick-lastTick;
+
+	++changeCount;
+	if(cv>=pcAmp1 && cv<pcAmp1+SYNTH_VOICE_COUNT)
+	{
+		if(!amps[cv-pcAmp1])
+			++ampStarts[cv-pcAmp1];
+		amps[cv-pcAmp1]=value;
+	}
+
+	if(!out)
+		return;
+
+	do
+	{
+		fputc((delta&0x7f)|(delta>0x7f?0x80:0),out);
+		delta>>=7;
+	}
+	while(delta);
+
+	fputc(cv==P600SIM_TRACE_GATES?GATES_INDEX:cv,out);
+	writeU16(value);
+
+	lastTick=tick;
+}
+
+static void writeHeader(void)
+{
+	int8_t i;
+
+	fwrite("P6CV",1,4,out);
+	fputc(TIMELINE_VERSION,out);
+	fputc(CV_COUNT,out);
+	writeU16(TICK_HERTZ);
+
+	for(i=0;i<CV_COUNT;++i)
+		writeU16(p600sim_getCV(i));
+	fputc(p600sim_getGates(),out);
+}
+
+int main(int argc, char ** argv)
+{
+	uint32_t next=0,end;
+	double tail=argc>3?atof(argv[3]):DEFAULT_TAIL;
+	double start,elapsed;
+	int8_t v;
+
+	if(argc<2)
+	{
+		fprintf(stderr,"usage: %s file.mid [timeline|-] [tail seconds]\n",argv[0]);
+		return 2;
+	}
+
+	if(!loadSMF(argv[1]))
+		return 2;
+	applyTempoMap();
+
+	if(argc>2 && strcmp(argv[2],"-") && !(out=fopen(argv[2],"wb")))
+	{
+		perror(argv[2]);
+		return 2;
+	}
+
+	start=cpuSeconds();
+
+	p600sim_init(1);
+	p600sim_setDefaultPanel();
+	p600sim_bootSynth();
+
+	if(out)
+		writeHeader();
+	p600sim_setTrace(timelineEvent);
+
+	end=(smf.count?smf.events[smf.count-1].time:0)+(uint32_t)(tail*TICK_HERTZ);
+
+	for(tick=0;tick<=end;++tick)
+	{
+		while(next<smf.count && smf.events[next].time<=tick)
+			playEvent(&smf.events[next++]);
+
+		synth_timerInterrupt();
+
+		if(tick%UPDATE_TICKS==0)
+			synth_update();
+	}
+
+	p600sim_setTrace(NULL);
+	if(out)
+		fclose(out);
+
+	elapsed=cpuSeconds()-start;
+
+	printf("%s: %.1f s rendered in %.2f s (%.0fx realtime), %u MIDI events, %u CV changes\n",
+			argv[1],(double)end/TICK_HERTZ,elapsed,elapsed>0.0?end/(TICK_HERTZ*elapsed):0.0,smf.count,changeCount);
+
+	printf("  voice starts:");
+	for(v=0;v<SYNTH_VOICE_COUNT;++v)
+		printf(" %u",ampStarts[v]);
+	printf("\n");
+
+	return 0;
+}
@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////
+// Virtual P600 voice board for host builds: VCO A/B (saw, tri, pulse, sync,
+// poly mod), 4 pole VCF, VCA, driven by the S&H CVs and the gates latch.
+// All six voices run side by side in the lanes of GCC vector types.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+
+#include "p600audio.h"
+#include "p600sim.h"
+
+#define MAX_INCREMENT 0.45f // keeps oscs below nyquist
+#define MAX_CUTOFF 0.99f
+#define SELF_OSCILLATION 0xc000 // resonance CV, as in p600sim.c
+#define DC_BLOCK_POLE 0.995f
+
+typedef int32_t maskLanes_t __attribute__((vector_size(P600AUDIO_LANES*sizeof(int32_t))));
+
+static const p600audioLanes_t zero={0};
+static const p600audioLanes_t one={1,1,1,1,1,1,1,1};
+
+static inline p600audioLanes_t selectLanes(maskLanes_t m, p600audioLanes_t a, p600audioLanes_t b)
+{
+	return (p600audioLanes_t)((m&(maskLanes_t)a)|(~m&(maskLanes_t)b));
+}
+
+static inline p600audioLanes_t absLanes(p600audioLanes_t x)
+{
+	return (p600audioLanes_t)((maskLanes_t)x&0x7fffffff);
+}
+
+// polynomial band limited step, removes most of the aliasing of a naive discontinuity at phase 0
+static inline p600audioLanes_t polyBlep(p600audioLanes_t t, p600audioLanes_t dt)
+{
+	p600audioLanes_t x,y;
+
+	x=t/dt;
+	y=selectLanes(t<dt,x+x-x*x-1.0f,zero);
+	x=(t-1.0f)/dt;
+	return selectLanes(t>1.0f-dt,x*x+x+x+1.0f,y);
+}
+
+static inline p600audioLanes_t wrap(p600audioLanes_t p)
+{
+	return p-selectLanes(p>=1.0f,one,zero);
+}
+
+static p600audioLanes_t osc(p600audioLanes_t p, p600audioLanes_t dt, float pw, float saw, float tri, float pulse)
+{
+	p600audioLanes_t out,pp;
+
+	out=saw*(2.0f*p-1.0f-polyBlep(p,dt));
+	out+=tri*(1.0f-4.0f*absLanes(p-0.5f));
+
+	if(pulse)
+	{
+		pp=wrap(p+(1.0f-pw));
+		out+=pulse*(selectLanes(p<pw,one,-one)+polyBlep(p,dt)-polyBlep(pp,dt));
+	}
+
+	return out;
+}
+
+static float cvToHertz(uint16_t cv, double offset, double scale)
+{
+	return P600SIM_LOWEST_HERTZ*exp2((cv-offset)/scale);
+}
+
+static void updateCoefficients(struct p600audio_s * a)
+{
+	int8_t v;
+	float fc;
+
+	for(v=0;v<SYNTH_VOICE_COUNT;++v)
+	{
+		a->incA[v]=fminf(cvToHertz(a->cvs[pcOsc1A+v],P600SIM_OSC_OFFSET,P600SIM_OSC_SCALE)/a->sampleRate,MAX_INCREMENT);
+		a->incB[v]=fminf(cvToHertz(a->cvs[pcOsc1B+v],P600SIM_OSC_OFFSET,P600SIM_OSC_SCALE)/a->sampleRate,MAX_INCREMENT);
+
+		fc=cvToHertz(a->cvs[pcFil1+v],P600SIM_FIL_OFFSET,P600SIM_FIL_SCALE);
+		a->cutoff[v]=fminf(1.0f-expf(-2.0f*M_PI*fc/a->sampleRate),MAX_CUTOFF);
+
+		a->amp[v]=a->cvs[pcAmp1+v]/65535.0f;
+	}
+
+	// the firmware parks the pulse width at an end of the range when the square is off
+	a->pwA=a->cvs[pcAPW]/65536.0f;
+	a->pwB=a->cvs[pcBPW]/65536.0f;
+	a->pulseA=a->cvs[pcAPW]>0 && a->cvs[pcAPW]<UINT16_MAX;
+	a->pulseB=a->cvs[pcBPW]>0 && a->cvs[pcBPW]<UINT16_MAX;
+
+	a->sawA=(a->gates>>pgASaw)&1;
+	a->triA=(a->gates>>pgATri)&1;
+	a->sawB=(a->gates>>pgBSaw)&1;
+	a->triB=(a->gates>>pgBTri)&1;
+	a->sync=(a->gates>>pgSync)&1;
+	a->pmodA=(a->gates>>pgPModFA)&1;
+	a->pmodFil=(a->gates>>pgPModFil)&1;
+
+	a->volA=a->cvs[pcVolA]/65535.0f;
+	a->volB=a->cvs[pcVolB]/65535.0f;
+	a->resonance=4.0f*a->cvs[pcResonance]/SELF_OSCILLATION;
+	a->masterVolume=a->cvs[pcMVol]/65535.0f;
+	a->noise=a->cvs[pcExtFil]/65535.0f;
+	a->pmodAmount=a->cvs[pcPModOscB]/65535.0f;
+
+	a->dirty=0;
+}
+
+void p600audio_init(struct p600audio_s * a, float sampleRate)
+{
+	memset(a,0,sizeof(*a));
+	a->sampleRate=sampleRate;
+	a->rng=1;
+	a->dirty=1;
+}
+
+void p600audio_setCV(struct p600audio_s * a, p600CV_t cv, uint16_t value)
+{
+	a->cvs[cv]=value;
+	a->dirty=1;
+}
+
+void p600audio_setGates(struct p600audio_s * a, uint8_t gates)
+{
+	a->gates=gates;
+	a->dirty=1;
+}
+
+void p600audio_render(struct p600audio_s * a, float * out, int count)
+{
+	p600audioLanes_t b,oscA,mix,g,x,inc;
+	maskLanes_t wrappedB;
+	float n,sum;
+	int8_t v;
+
+	if(a->dirty)
+		updateCoefficients(a);
+
+	while(count--)
+	{
+		// osc B first, it syncs and modulates osc A
+
+		a->phaseB+=a->incB;
+		wrappedB=a->phaseB>=1.0f;
+		a->phaseB=wrap(a->phaseB);
+		b=osc(a->phaseB,a->incB,a->pwB,a->sawB,a->triB,a->pulseB);
+
+		inc=a->incA;
+		if(a->pmodA)
+			inc*=1.0f+a->pmodAmount*a->lastB;
+
+		a->phaseA=wrap(a->phaseA+inc);
+		if(a->sync)
+			a->phaseA=selectLanes(wrappedB,zero,a->phaseA);
+		oscA=osc(a->phaseA,inc,a->pwA,a->sawA,a->triA,a->pulseA);
+
+		a->lastB=b;
+
+		a->rng^=a->rng<<13;
+		a->rng^=a->rng>>17;
+		a->rng^=a->rng<<5;
+		n=(int32_t)a->rng*(1.0f/2147483648.0f);
+
+		mix=a->volA*oscA+a->volB*b+a->noise*n;
+
+		// 4 pole low pass, resonance feedback soft clipped
+
+		g=a->cutoff;
+		if(a->pmodFil)
+		{
+			g*=1.0f+a->pmodAmount*b;
+			g=selectLanes(g>MAX_CUTOFF,one*MAX_CUTOFF,selectLanes(g<0.0f,zero,g));
+		}
+
+		x=mix-a->resonance*a->s4;
+		x=x/(1.0f+absLanes(x));
+		a->s1+=g*(x-a->s1);
+		a->s2+=g*(a->s1-a->s2);
+		a->s3+=g*(a->s2-a->s3);
+		a->s4+=g*(a->s3-a->s4);
+
+		x=a->s4*a->amp;
+
+		sum=0.0f;
+		for(v=0;v<SYNTH_VOICE_COUNT;++v)
+			sum+=x[v];
+		sum*=a->masterVolume;
+
+		// no DC at the output, like the P600's coupling caps
+
+		a->dcOut=sum-a->dcIn+DC_BLOCK_POLE*a->dcOut;
+		a->dcIn=sum;
+
+		*out++=a->dcOut;
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef P600AUDIO_H
+#define	P600AUDIO_H
+
+#include "synth.h"
+
+// six voices in SIMD lanes, padded to 8 floats (two SSE or one AVX register)
+#define P600AUDIO_LANES 8
+
+typedef float p600audioLanes_t __attribute__((vector_size(P600AUDIO_LANES*sizeof(float))));
+
+// virtual P600 voice board, fed with S&H CVs and gates latch values;
+// instances are independent, one per thread
+struct p600audio_s
+{
+	float sampleRate;
+	uint16_t cvs[pcBPW+1];
+	uint8_t gates;
+	int8_t dirty; // CVs or gates changed since the coefficients were computed
+
+	// per voice
+	p600audioLanes_t phaseA,phaseB; // 0..1
+	p600audioLanes_t incA,incB; // phase increment per sample
+	p600audioLanes_t cutoff; // filter coefficient
+	p600audioLanes_t amp;
+	p600audioLanes_t s1,s2,s3,s4; // 4 pole filter stages
+	p600audioLanes_t lastB; // osc B output, for poly mod
+
+	// global
+	float pwA,pwB,volA,volB,sawA,triA,pulseA,sawB,triB,pulseB;
+	float resonance,masterVolume,noise,pmodAmount,pmodA,pmodFil,sync;
+	uint32_t rng;
+	float dcIn,dcOut;
+};
+
+void p600audio_init(struct p600audio_s * a, float sampleRate);
+void p600audio_setCV(struct p600audio_s * a, p600CV_t cv, uint16_t value);
+void p600audio_setGates(struct p600audio_s * a, uint8_t gates);
+
+// mono, -1..1 for a voice at full level
+void p600audio_render(struct p600audio_s * a, float * out, int count);
+
+#endif	/* P600AUDIO_H */
@@ -0,0 +1,565 @@
+////////////////////////////////////////////////////////////////////////////////
+// Simulated P600 hardware for host builds: bus, S&H, gates, VCO/VCF bank,
+// tune circuit (flip flop + 8253), key matrix, pots, storage and UART status
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "p600sim.h"
+#include "storage.h"
+
+#define BUS_ACCESS_TIME 0.5e-6 // bit banged Z80 bus, about 8 AVR cycles
+#define COUNTER_HERTZ 2000000.0 // 8253 channel 1 clock
+
+// CS06 bits, as in tuner.c
+#define FF_P	0x01 // active low
+#define CNTR_EN 0x02
+#define FF_D	0x08
+#define FF_CL	0x10 // active low
+
+#define CV_ON 0x8000 // amp / mixer level considered open by the tune circuit
+#define CV_SELF_OSCILLATION 0xc000 // resonance
+
+struct counter_s
+{
+	uint16_t count,load;
+	uint8_t lsb;
+	int8_t writeMsb,readMsb;
+};
+
+static struct
+{
+	double time;
+	uint32_t rng;
+
+	// bus side
+
+	uint8_t dacHi,dacLo;
+	uint16_t cvs[32];
+	uint8_t gates;
+	uint8_t tune; // CS06 latch
+	p600simTrace_t trace;
+
+	// panel: key matrix rows and pots, read through the potmux comparator
+
+	uint8_t row;
+	uint8_t keys[16];
+	int8_t pot; // selected by the potmux, -1: none
+	uint16_t pots[32];
+
+	// tune circuit: flip flop clocked by the audio, gating the 8253
+
+	int8_t q;
+	int8_t out2;
+	struct counter_s counters[3];
+
+	// audio sources, each one gives an edge per period
+
+	struct p600simSource_s sources[P600SIM_SOURCE_COUNT];
+	int8_t active[P600SIM_SOURCE_COUNT];
+	double period[P600SIM_SOURCE_COUNT];
+	double nextEdge[P600SIM_SOURCE_COUNT];
+	int8_t first; // source with the earliest edge, -1: silence
+	int8_t sourcesChanged; // CVs or gates changed, refresh before time moves on
+
+	uint8_t fram[STORAGE_SIZE];
+} sim;
+
+static double uniform(void)
+{
+	// xorshift32
+	sim.rng^=sim.rng<<13;
+	sim.rng^=sim.rng>>17;
+	sim.rng^=sim.rng<<5;
+	return (sim.rng>>8)/16777216.0;
+}
+
+static double gaussian(void)
+{
+	return sqrt(-2.0*log(1.0-uniform()))*cos(2.0*M_PI*uniform());
+}
+
+static double sourceFrequency(int8_t s, uint16_t value)
+{
+	struct p600simSource_s * src=&sim.sources[s];
+	double oct;
+
+	oct=(value-src->offset)/src->scale;
+
+	return P600SIM_LOWEST_HERTZ*pow(2.0,oct+(src->bend*(oct-4.0)*(oct-4.0)+src->drift*sim.time)/1200.0);
+}
+
+static int8_t isAudible(int8_t s)
+{
+	int8_t v=s%SYNTH_VOICE_COUNT;
+	uint16_t fil=sim.cvs[pcFil1+v];
+
+	if(sim.cvs[pcAmp1+v]<CV_ON)
+		return 0;
+
+	if(s>=pcFil1)
+		return sim.cvs[pcResonance]>=CV_SELF_OSCILLATION;
+
+	// oscs only get through an open enough filter
+
+	if(sourceFrequency(pcFil1+v,fil)<sourceFrequency(s,sim.cvs[s]))
+		return 0;
+
+	if(s<pcOsc1B)
+		return sim.cvs[pcVolA]>=CV_ON && (sim.gates&((1<<pgASaw)|(1<<pgATri)));
+	else
+		return sim.cvs[pcVolB]>=CV_ON && (sim.gates&((1<<pgBSaw)|(1<<pgBTri)));
+}
+
+static void findFirstEdge(void)
+{
+	int8_t s;
+
+	sim.first=-1;
+	for(s=0;s<P600SIM_SOURCE_COUNT;++s)
+		if(sim.active[s] && (sim.first<0 || sim.nextEdge[s]<sim.nextEdge[sim.first]))
+			sim.first=s;
+}
+
+static void refreshSources(void)
+{
+	int8_t s;
+	double p;
+
+	for(s=0;s<P600SIM_SOURCE_COUNT;++s)
+	{
+		if(!isAudible(s))
+		{
+			sim.active[s]=0;
+			continue;
+		}
+
+		p=1.0/sourceFrequency(s,sim.cvs[s]);
+
+		if(!sim.active[s])
+			sim.nextEdge[s]=sim.time+p*uniform(); // random phase
+		else
+			sim.nextEdge[s]=sim.time+(sim.nextEdge[s]-sim.time)*p/sim.period[s]; // CV change, keep the phase
+
+		sim.active[s]=1;
+		sim.period[s]=p;
+	}
+
+	findFirstEdge();
+}
+
+static int8_t isCounting(void)
+{
+	return (sim.tune&CNTR_EN) && !sim.out2;
+}
+
+static void count(double to)
+{
+	if(isCounting())
+		sim.counters[1].count-=(uint16_t)(floor(to*COUNTER_HERTZ)-floor(sim.time*COUNTER_HERTZ));
+	sim.time=to;
+}
+
+static void audioEdge(int8_t s)
+{
+	int8_t q,running;
+
+	running=!sim.out2;
+
+	// flip flop, clocked by the audio
+
+	if(!(sim.tune&FF_CL))
+		q=0;
+	else if(!(sim.tune&FF_P))
+		q=1;
+	else
+		q=(sim.tune&FF_D)!=0;
+
+	// channel 2 is a one shot clocked by the audio, started by the flip flop,
+	// it gates channel 1 for the next audio period
+
+	if(q && !sim.q && !running)
+	{
+		sim.counters[2].count=sim.counters[2].load;
+		sim.out2=0;
+	}
+	sim.q=q;
+
+	if(running && !--sim.counters[2].count)
+		sim.out2=1;
+
+	sim.nextEdge[s]+=sim.period[s]*(1.0+sim.sources[s].noise*gaussian());
+	findFirstEdge();
+}
+
+void p600sim_advance(double seconds)
+{
+	double to=sim.time+seconds;
+
+	if(sim.sourcesChanged)
+	{
+		refreshSources();
+		sim.sourcesChanged=0;
+	}
+
+	while(sim.first>=0 && sim.nextEdge[sim.first]<=to)
+	{
+		count(sim.nextEdge[sim.first]);
+		audioEdge(sim.first);
+	}
+
+	count(to);
+}
+
+static void writeTune(uint8_t value)
+{
+	sim.tune=value;
+
+	// asynchronous preset / clear
+
+	if(!(value&FF_CL))
+		sim.q=0;
+	else if(!(value&FF_P))
+		sim.q=1;
+}
+
+static void write8253(uint8_t address, uint8_t value)
+{
+	struct counter_s * c;
+
+	if(address==3) // control word, only 2 bytes access is used
+	{
+		c=&sim.counters[value>>6];
+		c->writeMsb=c->readMsb=0;
+		return;
+	}
+
+	c=&sim.counters[address];
+
+	if(!c->writeMsb)
+	{
+		c->lsb=value;
+	}
+	else
+	{
+		c->load=(value<<8)|c->lsb;
+		if(address!=2) // channel 2 waits for its trigger
+			c->count=c->load;
+	}
+
+	c->writeMsb=!c->writeMsb;
+}
+
+static uint8_t read8253(uint8_t address)
+{
+	struct counter_s * c=&sim.counters[address];
+	uint8_t v;
+
+	v=c->readMsb?c->count>>8:c->count;
+	c->readMsb=!c->readMsb;
+
+	return v;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// hardware.h implementation
+////////////////////////////////////////////////////////////////////////////////
+
+static void setCV(int8_t cv, uint16_t value)
+{
+	if(sim.cvs[cv]==value)
+		return;
+
+	sim.cvs[cv]=value;
+	sim.sourcesChanged=1;
+	if(sim.trace)
+		sim.trace(cv,value);
+}
+
+static void selectPot(uint8_t mux)
+{
+	// see updatePot() in potmux.c, both bank selects high: none
+	if((mux&0x30)==0x30)
+		sim.pot=-1;
+	else
+		sim.pot=(mux&0x0f)|((mux&0x20)?0:16);
+}
+
+static int8_t isDACLower(void)
+{
+	uint16_t dac=((uint16_t)sim.dacHi<<10)|((uint16_t)sim.dacLo<<2);
+
+	return sim.pot>=0 && dac<sim.pots[sim.pot];
+}
+
+void mem_write(uint16_t address, uint8_t value)
+{
+	p600sim_advance(BUS_ACCESS_TIME);
+
+	// see dac.c
+	if(address==0x4001)
+		sim.dacHi=value&0x3f;
+	else if(address==0x4000)
+		sim.dacLo=value;
+}
+
+uint8_t mem_read(uint16_t address)
+{
+	p600sim_advance(BUS_ACCESS_TIME);
+
+	if(address==0xe000) // UART status: transmit register empty, nothing received
+		return 0x02;
+
+	return 0;
+}
+
+void io_write(uint8_t address, uint8_t value)
+{
+	int8_t b;
+
+	p600sim_advance(BUS_ACCESS_TIME);
+
+	if(address<=3)
+	{
+		write8253(address,value);
+	}
+	else if(address==CS05)
+	{
+		// S&H banks are selected by active low bits 3-6
+		for(b=0;b<4;++b)
+			if(!(value&(0x08<<b)))
+				setCV(b*8+(value&7),((uint16_t)sim.dacHi<<10)|((uint16_t)sim.dacLo<<2));
+	}
+	else if(address==CSO3)
+	{
+		if(sim.gates!=value)
+		{
+			sim.sourcesChanged=1;
+			if(sim.trace)
+				sim.trace(P600SIM_TRACE_GATES,value);
+		}
+		sim.gates=value;
+	}
+	else if(address==CSO0)
+	{
+		sim.row=value&0x0f;
+	}
+	else if(address==CSO2)
+	{
+		selectPot(value);
+	}
+	else if(address==CS06)
+	{
+		writeTune(value);
+	}
+}
+
+uint8_t io_read(uint8_t address)
+{
+	p600sim_advance(BUS_ACCESS_TIME);
+
+	if(address<=2)
+		return read8253(address);
+	else if(address==CSI0)
+		return ((!sim.q)<<1)|(sim.out2<<2)|(isDACLower()<<3);
+	else if(address==CSI1)
+		return sim.keys[sim.row];
+
+	return 0;
+}
+
+int8_t hardware_getNMIState(void)
+{
+	return 0;
+}
+
+// no stack painting on the host
+
+uint16_t hardware_getStaticRAM(void)
+{
+	return 0;
+}
+
+uint16_t hardware_getStackUsage(void)
+{
+	return 0;
+}
+
+uint16_t hardware_getRAMFree(void)
+{
+	return 0;
+}
+
+void storage_write(uint32_t pageIdx, uint8_t *buf)
+{
+	memcpy(&sim.fram[pageIdx*STORAGE_PAGE_SIZE],buf,STORAGE_PAGE_SIZE);
+}
+
+void storage_read(uint32_t pageIdx, uint8_t *buf)
+{
+	memcpy(buf,&sim.fram[pageIdx*STORAGE_PAGE_SIZE],STORAGE_PAGE_SIZE);
+}
+
+void storage_writeBytes(uint16_t address, uint8_t *buf, uint16_t size)
+{
+	memcpy(&sim.fram[address],buf,size);
+}
+
+void storage_readBytes(uint16_t address, uint8_t *buf, uint16_t size)
+{
+	memcpy(buf,&sim.fram[address],size);
+}
+
+char * itoa(int value, char * s, int radix)
+{
+	// only decimal is used
+	sprintf(s,"%d",value);
+	return s;
+}
+
+char * utoa(unsigned int value, char * s, int radix)
+{
+	sprintf(s,"%u",value);
+	return s;
+}
+
+void print_P(const char *s)
+{
+	fputs(s,stderr);
+}
+
+void phex(unsigned char c)
+{
+	fprintf(stderr,"%02x",c);
+}
+
+void phex16(unsigned int i)
+{
+	fprintf(stderr,"%04x",i&0xffff);
+}
+
+void usb_debug_putchar(char c)
+{
+	fputc(c,stderr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Simulation control
+////////////////////////////////////////////////////////////////////////////////
+
+void p600sim_init(uint32_t seed)
+{
+	int8_t s;
+
+	memset(&sim,0,sizeof(sim));
+	sim.rng=seed?seed:1;
+	sim.out2=1;
+	sim.first=-1;
+	sim.tune=FF_P|FF_CL;
+	sim.pot=-1;
+
+	for(s=0;s<P600SIM_SOURCE_COUNT;++s)
+	{
+		// same as the tuner's theoretical tuning
+		if(s<pcFil1)
+		{
+			sim.sources[s].offset=P600SIM_OSC_OFFSET;
+			sim.sources[s].scale=P600SIM_OSC_SCALE;
+		}
+		else
+		{
+			sim.sources[s].offset=P600SIM_FIL_OFFSET;
+			sim.sources[s].scale=P600SIM_FIL_SCALE;
+		}
+	}
+}
+
+void p600sim_randomize(uint32_t seed, double spread)
+{
+	int8_t s;
+	struct p600simSource_s * src;
+
+	p600sim_init(seed);
+
+	for(s=0;s<P600SIM_SOURCE_COUNT;++s)
+	{
+		src=&sim.sources[s];
+
+		src->offset+=spread*(uniform()-0.5)*4000.0;
+		src->scale*=1.0+spread*(uniform()-0.5)*(s<pcFil1?0.1:0.2);
+		src->bend=spread*(uniform()-0.5)*10.0;
+		src->drift=spread*(uniform()-0.5)*0.1;
+		src->noise=spread*uniform()*0.001;
+	}
+}
+
+struct p600simSource_s * p600sim_getSource(p600CV_t cv)
+{
+	return &sim.sources[cv];
+}
+
+double p600sim_getFrequency(p600CV_t cv, uint16_t value)
+{
+	return sourceFrequency(cv,value);
+}
+
+double p600sim_getTime(void)
+{
+	return sim.time;
+}
+
+uint16_t p600sim_getCV(p600CV_t cv)
+{
+	return sim.cvs[cv];
+}
+
+void p600sim_setDefaultPanel(void)
+{
+	int8_t i;
+
+	// a plain panel: open filter and amp, both oscs audible, centered wheels and tunes
+
+	static const uint16_t pots[32]=
+	{
+		[ppMixer]=HALF_RANGE,[ppCutoff]=FULL_RANGE,[ppFilEnvAmt]=HALF_RANGE,[ppFilSus]=FULL_RANGE,
+		[ppAmpSus]=FULL_RANGE,[ppMVol]=FULL_RANGE,[ppMTune]=HALF_RANGE,[ppPitchWheel]=HALF_RANGE,
+		[ppSpeed]=HALF_RANGE,[ppAPW]=HALF_RANGE,[ppPModFilEnv]=HALF_RANGE,[ppFreqBFine]=HALF_RANGE,
+	};
+
+	for(i=0;i<32;++i)
+		sim.pots[i]=pots[i];
+}
+
+void p600sim_bootSynth(void)
+{
+	// valid settings in storage, so that synth_init() doesn't tune
+	settings_loadDefault();
+	settings_save();
+
+	synth_init();
+}
+
+uint8_t p600sim_getGates(void)
+{
+	return sim.gates;
+}
+
+void p600sim_setTrace(p600simTrace_t trace)
+{
+	sim.trace=trace;
+}
+
+void p600sim_setKey(uint8_t key, int8_t pressed)
+{
+	if(pressed)
+		sim.keys[key>>3]|=1<<(key&7);
+	else
+		sim.keys[key>>3]&=~(1<<(key&7));
+}
+
+void p600sim_setPot(p600Pot_t pot, uint16_t value)
+{
+	sim.pots[pot]=value;
+}
@@ -0,0 +1,53 @@
+#ifndef P600SIM_H
+#define	P600SIM_H
+
+#include "synth.h"
+
+#define P600SIM_LOWEST_HERTZ (261.63/16) // C0, octave 0 of the tuner
+
+// theoretical tuning, as in tuner.c: CV giving P600SIM_LOWEST_HERTZ, CV per octave
+#define P600SIM_OSC_OFFSET 5000.0
+#define P600SIM_OSC_SCALE (65536.0/10.66)
+#define P600SIM_FIL_OFFSET 10000.0
+#define P600SIM_FIL_SCALE (65536.0/21.0)
+
+#define P600SIM_SOURCE_COUNT (pcFil6-pcOsc1A+1) // oscs A, oscs B, self oscillating filters
+
+#define P600SIM_TRACE_GATES -1
+
+// called on every S&H output change (cv) or gates latch change (P600SIM_TRACE_GATES)
+typedef void (*p600simTrace_t)(int8_t cv, uint16_t value);
+
+struct p600simSource_s
+{
+	double offset; // CV giving P600SIM_LOWEST_HERTZ
+	double scale; // CV per octave
+	double bend; // tracking error, cents per octave squared away from octave 4
+	double drift; // cents per simulated second
+	double noise; // period jitter, relative standard deviation
+};
+
+// instance matching the tuner's theoretical tuning, no drift, no noise
+void p600sim_init(uint32_t seed);
+// randomized instance, spread=1.0 for about what real P600s show
+void p600sim_randomize(uint32_t seed, double spread);
+
+struct p600simSource_s * p600sim_getSource(p600CV_t cv);
+double p600sim_getFrequency(p600CV_t cv, uint16_t value); // model at the current time, without noise
+
+double p600sim_getTime(void); // in seconds
+void p600sim_advance(double seconds);
+
+uint16_t p600sim_getCV(p600CV_t cv); // S&H outputs
+uint8_t p600sim_getGates(void);
+void p600sim_setTrace(p600simTrace_t trace);
+
+// panel inputs, key is the scanner matrix index (buttons, then keyboard from SCANNER_KEYS_START)
+void p600sim_setKey(uint8_t key, int8_t pressed);
+void p600sim_setPot(p600Pot_t pot, uint16_t value);
+void p600sim_setDefaultPanel(void);
+
+// power on with the theoretical tuning, without an autotune
+void p600sim_bootSynth(void);
+
+#endif	/* P600SIM_H */
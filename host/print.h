@@ -0,0 +1,16 @@
+#ifndef print_h__
+#define print_h__
+
+#include <avr/pgmspace.h>
+
+// same interface as the firmware one, prints to stderr
+
+#define print(s) print_P(PSTR(s))
+#define pchar(c) usb_debug_putchar(c)
+
+void print_P(const char *s);
+void phex(unsigned char c);
+void phex16(unsigned int i);
+void usb_debug_putchar(char c);
+
+#endif
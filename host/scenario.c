@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+// Scenario files, see scenario.h
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+
+#include "scenario.h"
+#include "scanner.h"
+
+#define KEYBOARD_START 64 // matrix index of the lowest key, as in scanner.c
+
+int scenario_load(const char * name, struct scenarioEvent_s * events)
+{
+	FILE * f;
+	char line[256],type[16],*p;
+	struct scenarioEvent_s * e;
+	int n,v,index,value,lineNumber=0,eventCount=0;
+
+	if(!(f=fopen(name,"r")))
+	{
+		perror(name);
+		return 0;
+	}
+
+	while(fgets(line,sizeof(line),f))
+	{
+		++lineNumber;
+
+		if((p=strchr(line,'#')))
+			*p=0;
+
+		if(sscanf(line,"%d %15s%n",&v,type,&n)<2)
+			continue;
+
+		if(eventCount>=SCENARIO_MAX_EVENTS)
+		{
+			fprintf(stderr,"%s:%d: more than %d events\n",name,lineNumber,SCENARIO_MAX_EVENTS);
+			fclose(f);
+			return 0;
+		}
+
+		e=&events[eventCount++];
+		memset(e,0,sizeof(*e));
+		e->tick=v;
+		p=line+n;
+
+		if(!strcmp(type,"midi"))
+		{
+			e->type=etMidi;
+			while(e->midiSize<sizeof(e->midi) && sscanf(p,"%x%n",&value,&n)==1)
+			{
+				if(value<0 || value>0xff)
+					goto error;
+				e->midi[e->midiSize++]=value;
+				p+=n;
+			}
+
+			// more bytes than fit, or not hex, must not be dropped silently
+			if(!e->midiSize || sscanf(p," %1s",type)==1)
+				goto error;
+		}
+		else if(!strcmp(type,"key") || !strcmp(type,"button") || !strcmp(type,"note"))
+		{
+			if(sscanf(p,"%d %d",&index,&value)!=2)
+				goto error;
+
+			e->type=etKey;
+			e->index=index;
+			e->value=value;
+
+			// keyboard notes are shifted into the scanner matrix
+			if(!strcmp(type,"note"))
+				e->index+=KEYBOARD_START-SCANNER_BASE_NOTE;
+		}
+		else if(!strcmp(type,"pot"))
+		{
+			if(sscanf(p,"%d %i",&index,&value)!=2 || index<0 || index>=32)
+				goto error;
+
+			e->type=etPot;
+			e->index=index;
+			e->value=value;
+		}
+		else if(!strcmp(type,"end"))
+		{
+			e->type=etEnd;
+		}
+		else
+		{
+			goto error;
+		}
+	}
+
+	fclose(f);
+
+	if(!eventCount || events[eventCount-1].type!=etEnd)
+	{
+		fprintf(stderr,"%s: scenario must finish with an end event\n",name);
+		return 0;
+	}
+
+	return eventCount;
+
+error:
+	fprintf(stderr,"%s:%d: bad event\n",name,lineNumber);
+	fclose(f);
+	return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef SCENARIO_H
+#define	SCENARIO_H
+
+#include <stdint.h>
+
+// scripted scenarios of host/scenarios, one event per line: "tick type args # comment"
+//   tick midi hex..        MIDI bytes, at most 18 per line, more is an error
+//   tick key index 0|1     scanner matrix key, also "button"
+//   tick note number 0|1   keyboard key, by MIDI note number
+//   tick pot index value   potmux input
+//   tick end               last tick, must finish the scenario
+
+#define SCENARIO_MAX_EVENTS 4096
+
+enum scenarioEventType_e {etMidi,etKey,etPot,etEnd};
+
+// same layout with or without the firmware's -fpack-struct -fshort-enums
+struct scenarioEvent_s
+{
+	int32_t tick;
+	uint16_t index,value;
+	uint8_t type; // scenarioEventType_e
+	uint8_t midiSize;
+	uint8_t midi[18];
+};
+
+// returns the event count, 0 on error (printed to stderr)
+int scenario_load(const char * name, struct scenarioEvent_s * events);
+
+#endif	/* SCENARIO_H */
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////
+// Autotune benchmark: tunes randomized simulated synths, reports accuracy,
+// probe count and simulated time, for a cold tune and a retune after drift.
+// Built twice, tunebench_sa with TUNER_SUCCESSIVE_APPROXIMATION is the baseline.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "p600sim.h"
+#include "tuner.h"
+#include "storage.h"
+
+#define DRIFT_SECONDS 600.0 // between the cold tune and the retune
+
+struct result_s
+{
+	double probes,seconds;
+	double oscCents[TUNER_OCTAVE_COUNT],filCents[TUNER_OCTAVE_COUNT];
+	double maxCents,maxExtrapolatedCents;
+};
+
+struct limits_s
+{
+	double cents,probes,seconds; // 0: no limit
+};
+
+// "cold[,retune]", a single value is for both
+static void parseLimit(const char * arg, double * cold, double * warm)
+{
+	if(sscanf(arg,"%lf,%lf",cold,warm)<2)
+		*warm=*cold;
+}
+
+static int8_t isTuned(int8_t cv, int8_t oct)
+{
+	if(cv<pcFil1)
+		return oct>=TUNER_OSC_NTH_C_LO && oct<=TUNER_OSC_NTH_C_HI;
+	else
+		return oct>=TUNER_FIL_NTH_C_LO && oct<=TUNER_FIL_NTH_C_HI;
+}
+
+static void measure(struct result_s * r)
+{
+	double t;
+	int8_t cv,oct;
+	double c;
+
+	t=p600sim_getTime();
+	tuner_tuneSynth();
+
+	r->seconds+=p600sim_getTime()-t;
+	r->probes+=tuner_getProbeCount();
+
+	for(cv=pcOsc1A;cv<=pcFil6;++cv)
+		for(oct=0;oct<TUNER_OCTAVE_COUNT;++oct)
+		{
+			c=1200.0*log2(p600sim_getFrequency(cv,settings.tunes[oct][cv])/(P600SIM_LOWEST_HERTZ*pow(2.0,oct)));
+			c=fabs(c);
+
+			if(cv<pcFil1)
+				r->oscCents[oct]+=c/(2*SYNTH_VOICE_COUNT);
+			else
+				r->filCents[oct]+=c/SYNTH_VOICE_COUNT;
+
+			if(!isTuned(cv,oct))
+				r->maxExtrapolatedCents=MAX(r->maxExtrapolatedCents,c);
+			else
+				r->maxCents=MAX(r->maxCents,c);
+		}
+}
+
+// extrapolated octaves are in parentheses, 0 on failure
+static int report(const char * name, struct result_s * r, int instances, struct limits_s * l)
+{
+	int8_t oct;
+	int res=1;
+
+	printf("%-8s probes %6.1f  seconds %6.2f  max %7.2f cents  (extrapolated %7.2f)\n",
+			name,r->probes/instances,r->seconds/instances,r->maxCents,r->maxExtrapolatedCents);
+
+	printf("  osc |cents| by octave:");
+	for(oct=0;oct<TUNER_OCTAVE_COUNT;++oct)
+		printf(isTuned(pcOsc1A,oct)?"  %6.2f ":" (%6.2f)",r->oscCents[oct]/instances);
+	printf("\n  fil |cents| by octave:");
+	for(oct=0;oct<TUNER_OCTAVE_COUNT;++oct)
+		printf(isTuned(pcFil1,oct)?"  %6.2f ":" (%6.2f)",r->filCents[oct]/instances);
+	printf("\n");
+
+	if(l->cents && r->maxCents>l->cents)
+	{
+		printf("FAILED: %s max %.2f cents, limit %.2f\n",name,r->maxCents,l->cents);
+		res=0;
+	}
+	if(l->probes && r->probes/instances>l->probes)
+	{
+		printf("FAILED: %s %.1f probes, limit %.1f\n",name,r->probes/instances,l->probes);
+		res=0;
+	}
+	if(l->seconds && r->seconds/instances>l->seconds)
+	{
+		printf("FAILED: %s %.2f seconds, limit %.2f\n",name,r->seconds/instances,l->seconds);
+		res=0;
+	}
+
+	return res;
+}
+
+static int usage(const char * name)
+{
+	fprintf(stderr,"usage: %s [-c max tuned cents] [-p max probes] [-s max seconds] [instances] [seed] [spread]\n"
+			"  limits are cold[,retune], the exit code is 1 when one is exceeded\n",name);
+	return 1;
+}
+
+int main(int argc, char ** argv)
+{
+	struct limits_s coldLimits={0},warmLimits={0};
+	struct result_s cold={0},warm={0};
+	int i,opt,instances,ok;
+	uint32_t seed;
+	double spread;
+
+	while((opt=getopt(argc,argv,"c:p:s:"))!=-1)
+		switch(opt)
+		{
+		case 'c':
+			parseLimit(optarg,&coldLimits.cents,&warmLimits.cents);
+			break;
+		case 'p':
+			parseLimit(optarg,&coldLimits.probes,&warmLimits.probes);
+			break;
+		case 's':
+			parseLimit(optarg,&coldLimits.seconds,&warmLimits.seconds);
+			break;
+		default:
+			return usage(argv[0]);
+		}
+
+	instances=optind<argc?atoi(argv[optind]):100;
+	seed=optind+1<argc?strtoul(argv[optind+1],NULL,0):1;
+	spread=optind+2<argc?atof(argv[optind+2]):1.0;
+
+	if(instances<=0)
+		return usage(argv[0]);
+
+	for(i=0;i<instances;++i)
+	{
+		p600sim_randomize(seed+i,spread);
+		settings_loadDefault(); // theoretical tuning
+
+		measure(&cold);
+
+		p600sim_advance(DRIFT_SECONDS);
+		measure(&warm);
+	}
+
+	printf("%d instances, seed %u, spread %.2f\n",instances,seed,spread);
+	ok=report("cold",&cold,instances,&coldLimits);
+	ok&=report("retune",&warm,instances,&warmLimits);
+
+	return ok?0:1;
+}
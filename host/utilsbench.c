@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////////////////////////
+// utils.c primitives microbenchmark: checks each one against a plain reference
+// on pseudo random inputs, then times it. Builds for the host and for the AVR
+// (utilsbench.elf, run on simavr, cycles counted with timer 1)
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+
+#include "utils.h"
+#include "lfo_lookups.h"
+
+#ifdef AVR
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "avr_mcu_section.h"
+
+AVR_MCU(F_CPU,"atmega1281");
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0); // simavr prints what is written there
+
+#define CHECK_COUNT 2000L
+#define BATCH_SIZE 16 // short enough for the 16 bit timer
+#define TIME_BATCHES 256L
+#define TIME_UNIT "cycles"
+
+#else
+
+#include <time.h>
+
+#define CHECK_COUNT 10000000L
+#define BATCH_SIZE 1024
+#define TIME_BATCHES 10000L
+#define TIME_UNIT "ps"
+
+#endif
+
+// primitives and references behind the same signature, so that they are
+// called the same way; the call overhead is measured by "none" and removed
+typedef int32_t (*adapter_t)(uint32_t x, uint32_t y);
+
+struct bench_s
+{
+	const char * name;
+	adapter_t primitive,reference;
+	uint8_t tolerance; // vs the reference
+};
+
+static uint32_t rng=1;
+static uint32_t xs[BATCH_SIZE],ys[BATCH_SIZE];
+static volatile int32_t sink;
+
+static uint32_t xorshift(void)
+{
+	rng^=rng<<13;
+	rng^=rng>>17;
+	rng^=rng<<5;
+	return rng;
+}
+
+static int32_t none(uint32_t x, uint32_t y)
+{
+	return x;
+}
+
+static int32_t clamp(int32_t v, int32_t lo, int32_t hi)
+{
+	return v<lo?lo:v>hi?hi:v;
+}
+
+static int32_t sat16(uint32_t x, uint32_t y) {return satAddU16U16(x,y);}
+static int32_t sat16Ref(uint32_t x, uint32_t y) {return clamp((int32_t)(uint16_t)x+(uint16_t)y,0,UINT16_MAX);}
+
+static int32_t sat32(uint32_t x, uint32_t y) {return satAddU16S32(x,(int32_t)y>>12);}
+static int32_t sat32Ref(uint32_t x, uint32_t y) {return clamp((int32_t)(uint16_t)x+((int32_t)y>>12),0,UINT16_MAX);}
+
+static int32_t satS16(uint32_t x, uint32_t y) {return satAddU16S16(x,y);}
+static int32_t satS16Ref(uint32_t x, uint32_t y) {return clamp((int32_t)(uint16_t)x+(int16_t)y,0,UINT16_MAX);}
+
+static int32_t satS16S16(uint32_t x, uint32_t y) {return satAddS16S16(x,y);}
+static int32_t satS16S16Ref(uint32_t x, uint32_t y) {return (int32_t)(int16_t)x+(int16_t)y;}
+
+static int32_t scaleUU(uint32_t x, uint32_t y) {return scaleU16U16(x,y);}
+static int32_t scaleUURef(uint32_t x, uint32_t y) {return ((uint32_t)(uint16_t)x*(uint16_t)y)>>16;}
+
+static int32_t scaleUS(uint32_t x, uint32_t y) {return scaleU16S16(x,y);}
+static int32_t scaleUSRef(uint32_t x, uint32_t y) {return (int16_t)(((int32_t)(uint16_t)x*(int16_t)y)>>16);}
+
+static int32_t scaleProp(uint32_t x, uint32_t y) {return (uint16_t)scaleProportionalU16S16(x,y);}
+static int32_t scalePropRef(uint32_t x, uint32_t y) {return clamp(((int64_t)(uint16_t)x*(65536+(int16_t)y))>>16,0,UINT16_MAX);}
+
+// lerp() only interpolates upwards, computeShape_P() tables are increasing
+static int32_t lerpU16(uint32_t x, uint32_t y) {return lerp(MIN(x&0xffff,x>>16),MAX(x&0xffff,x>>16),y);}
+static int32_t lerpU16Ref(uint32_t x, uint32_t y)
+{
+	int32_t a=MIN(x&0xffff,x>>16),b=MAX(x&0xffff,x>>16);
+
+	return a+(uint8_t)y*((b-a)>>8);
+}
+
+static int32_t shape(uint32_t x, uint32_t y) {return computeShape_P(x&0xffffff,sineShape,y&1);}
+static int32_t shapeRef(uint32_t x, uint32_t y)
+{
+	uint8_t i=(x>>16)&0xff;
+	int32_t a=pgm_read_word(&sineShape[i]),b=pgm_read_word(&sineShape[i<UINT8_MAX?i+1:i]);
+
+	if(!(y&1))
+		return a;
+
+	return (uint16_t)(a+((x>>8)&0xff)*((b-a)>>8));
+}
+
+static int32_t lfsrU32(uint32_t x, uint32_t y) {return lfsr(x,(y&15)+1);}
+static int32_t lfsrU32Ref(uint32_t x, uint32_t y)
+{
+	uint8_t taps=(y&15)+1;
+
+	// taps 32, 30, 26, 25
+	while(taps--)
+		x=(x<<1)|(((x>>31)^(x>>29)^(x>>25)^(x>>24))&1);
+
+	return x;
+}
+
+static int32_t expCourse(uint32_t x, uint32_t y) {return exponentialCourse(x,EXPONENTIAL_COURSE_RATE(8000.0),UINT16_MAX);}
+static int32_t expCourseRef(uint32_t x, uint32_t y) {return exp(-(double)(uint16_t)x/8000.0)*65535.0;}
+
+static int32_t expRise(uint32_t x, uint32_t y) {return exponentialRise(x,EXPONENTIAL_COURSE_RATE(15000.0),870);}
+static int32_t expRiseRef(uint32_t x, uint32_t y) {return MIN((exp((double)(uint16_t)x/15000.0)-1.0)*870.0,UINT16_MAX);}
+
+static int32_t log2Fixed(uint32_t x, uint32_t y) {return log2U32(x>>(y&31));}
+static int32_t log2FixedRef(uint32_t x, uint32_t y) {return (x>>(y&31))?log2(x>>(y&31))*65536.0:0;}
+
+static const struct bench_s benches[]=
+{
+	{"none",none,none,0},
+	{"satAddU16U16",sat16,sat16Ref,0},
+	{"satAddU16S32",sat32,sat32Ref,0},
+	{"satAddU16S16",satS16,satS16Ref,0},
+	{"satAddS16S16",satS16S16,satS16S16Ref,0},
+	{"scaleU16U16",scaleUU,scaleUURef,0},
+	{"scaleU16S16",scaleUS,scaleUSRef,0},
+	{"scaleProportionalU16S16",scaleProp,scalePropRef,0},
+	{"lerp",lerpU16,lerpU16Ref,0},
+	{"computeShape_P",shape,shapeRef,0},
+	{"lfsr",lfsrU32,lfsrU32Ref,0},
+	{"exponentialCourse",expCourse,expCourseRef,1}, // the reference is float math
+	{"exponentialRise",expRise,expRiseRef,2}, // same
+	{"log2U32",log2Fixed,log2FixedRef,1}, // same
+};
+
+#ifdef AVR
+
+static int consolePut(char c, FILE * f)
+{
+	GPIOR0=c;
+	return 0;
+}
+
+static FILE console=FDEV_SETUP_STREAM(consolePut,NULL,_FDEV_SETUP_WRITE);
+
+// CPU cycles per call
+static uint32_t timeBench(adapter_t f)
+{
+	uint32_t total=0;
+	uint16_t start;
+	uint8_t i;
+	long b;
+
+	for(b=0;b<TIME_BATCHES;++b)
+	{
+		for(i=0;i<BATCH_SIZE;++i)
+		{
+			xs[i]=xorshift();
+			ys[i]=xorshift();
+		}
+
+		start=TCNT1;
+		for(i=0;i<BATCH_SIZE;++i)
+			sink=f(xs[i],ys[i]);
+		total+=(uint16_t)(TCNT1-start);
+	}
+
+	return total/((uint32_t)TIME_BATCHES*BATCH_SIZE);
+}
+
+#else
+
+static double seconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+// picoseconds per call
+static uint32_t timeBench(adapter_t f)
+{
+	double elapsed=0.0,start;
+	long b;
+	int i;
+
+	for(b=0;b<TIME_BATCHES;++b)
+	{
+		for(i=0;i<BATCH_SIZE;++i)
+		{
+			xs[i]=xorshift();
+			ys[i]=xorshift();
+		}
+
+		start=seconds();
+		for(i=0;i<BATCH_SIZE;++i)
+			sink=f(xs[i],ys[i]);
+		elapsed+=seconds()-start;
+	}
+
+	return elapsed*1e12/((double)TIME_BATCHES*BATCH_SIZE)+0.5;
+}
+
+#endif
+
+static uint32_t check(const struct bench_s * b, int32_t * worst)
+{
+	uint32_t errors=0,x,y;
+	int32_t diff;
+	long n;
+
+	*worst=0;
+	for(n=0;n<CHECK_COUNT;++n)
+	{
+		x=xorshift();
+		y=xorshift();
+
+		diff=labs(b->primitive(x,y)-b->reference(x,y));
+		if(diff>*worst)
+			*worst=diff;
+		if(diff>b->tolerance)
+			++errors;
+	}
+
+	return errors;
+}
+
+int main(void)
+{
+	uint8_t i;
+	uint32_t errors,overhead=0,t;
+	int32_t worst;
+	int8_t failed=0;
+
+#ifdef AVR
+	stdout=&console;
+	TCCR1B=1<<CS10; // CPU clock
+#endif
+
+	printf("%-24s %10s %6s %6s\n","primitive","mismatches","worst",TIME_UNIT);
+
+	for(i=0;i<sizeof(benches)/sizeof(benches[0]);++i)
+	{
+		errors=check(&benches[i],&worst);
+		t=timeBench(benches[i].primitive);
+
+		// per call cost of the adapter and the loop
+		if(benches[i].primitive==none)
+			overhead=t;
+		else
+			t=t>overhead?t-overhead:0;
+
+		printf("%-24s %10lu %6ld %6lu%s\n",benches[i].name,(unsigned long)errors,(long)worst,(unsigned long)t,errors?" FAILED":"");
+		failed|=errors!=0;
+	}
+
+	printf(failed?"FAILED\n":"all ok\n");
+
+#ifdef AVR
+	// simavr quits when sleeping with interrupts off
+	cli();
+	sleep_mode();
+#endif
+
+	return failed;
+}
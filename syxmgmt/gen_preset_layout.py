@@ -0,0 +1,60 @@
+"""Generates common/preset_layout.h, the firmware preset field table, from preset.spec.
+
+usage: python3 gen_preset_layout.py [preset.spec] [-o ../common/preset_layout.h]
+"""
+
+import optparse
+import os
+
+import preset_spec
+
+parser = optparse.OptionParser()
+parser.add_option(
+    '-o',
+    '--output_file',
+    dest='output_file',
+    default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "common", "preset_layout.h"),
+    help='Write output file to FILE',
+    metavar='FILE')
+
+options, args = parser.parse_args()
+
+fields = preset_spec.load(args[0] if args else preset_spec.DEFAULT_SPEC)
+
+out = []
+out.append('// generated by syxmgmt/gen_preset_layout.py from syxmgmt/preset.spec, do not edit')
+out.append('')
+out.append('#ifndef PRESET_LAYOUT_H')
+out.append('#define PRESET_LAYOUT_H')
+out.append('')
+out.append('#define PRESET_LAYOUT_VERSION %d' % preset_spec.latestVersion(fields))
+out.append('#define PRESET_FIELD_COUNT %d' % len(fields))
+out.append('')
+out.append('static const struct presetField_s presetLayout[PRESET_FIELD_COUNT] PROGMEM =')
+out.append('{')
+
+for field in fields:
+    flags = []
+    if field.size == 2:
+        flags.append('PF_WORD')
+    if not field.target:
+        flags.append('PF_UNUSED')
+    if field.max is not None:
+        if field.max > 255:
+            raise ValueError('%s: max must fit in 8 bits' % field.name)
+        flags.append('PF_MAX')
+
+    out.append('\t{%d,%s,%d,%s,%d}, // %s' % (
+        field.since,
+        '|'.join(flags) if flags else '0',
+        field.count,
+        'offsetof(struct preset_s,%s)' % field.target if field.target else '0',
+        field.max if field.max is not None else 0,
+        field.name))
+
+out.append('};')
+out.append('')
+out.append('#endif')
+
+with open(options.output_file, "wt", newline='\n') as f:
+    f.write('\n'.join(out) + '\n')
@@ -0,0 +1,69 @@
+# Stored preset layout, in storage order (after the 4 bytes magic and 1 byte version).
+# This file is the reference for both common/preset_layout.h (see gen_preset_layout.py) and syx_converter.py.
+# Adding a field to a new storage version only requires a new line at the end.
+#
+# name;count;bytes per value;storage version it appeared in;target in struct preset_s (empty: unused slot, zero on save);max valid value (optional, invalid values are ignored on load)
+Frequency A;1;2;1;continuousParameters[cpFreqA];
+Volume A;1;2;1;continuousParameters[cpVolA];
+PWA;1;2;1;continuousParameters[cpAPW];
+Frequency B;1;2;1;continuousParameters[cpFreqB];
+Volume B;1;2;1;continuousParameters[cpVolB];
+PWB;1;2;1;continuousParameters[cpBPW];
+Frequency Fine B;1;2;1;continuousParameters[cpFreqBFine];
+Cutoff;1;2;1;continuousParameters[cpCutoff];
+Resonance;1;2;1;continuousParameters[cpResonance];
+Filter Envelope Amount;1;2;1;continuousParameters[cpFilEnvAmt];
+Filter Release;1;2;1;continuousParameters[cpFilRel];
+Filter Sustain;1;2;1;continuousParameters[cpFilSus];
+Filter Decay;1;2;1;continuousParameters[cpFilDec];
+Filter Attack;1;2;1;continuousParameters[cpFilAtt];
+2nd Release;1;2;1;continuousParameters[cpAmpRel];
+2nd Sustain;1;2;1;continuousParameters[cpAmpSus];
+2nd Decay;1;2;1;continuousParameters[cpAmpDec];
+2nd Attack;1;2;1;continuousParameters[cpAmpAtt];
+Poly Mod Envelope Amount;1;2;1;continuousParameters[cpPModFilEnv];
+Poly Mod OSC B;1;2;1;continuousParameters[cpPModOscB];
+LFO Frequency;1;2;1;continuousParameters[cpLFOFreq];
+LFO Amount;1;2;1;continuousParameters[cpLFOAmt];
+Glide;1;2;1;continuousParameters[cpGlide];
+Amp Velocity;1;2;1;continuousParameters[cpAmpVelocity];
+Filter Velocity;1;2;1;continuousParameters[cpFilVelocity];
+Saw A;1;1;1;steppedParameters[spASaw];
+Tri A;1;1;1;steppedParameters[spATri];
+SQR A;1;1;1;steppedParameters[spASqr];
+Saw B;1;1;1;steppedParameters[spBSaw];
+Tri B;1;1;1;steppedParameters[spBTri];
+SQR B;1;1;1;steppedParameters[spBSqr];
+Sync;1;1;1;steppedParameters[spSync];
+Poly Mod Frequency A;1;1;1;steppedParameters[spPModFA];
+Poly Mod Filter;1;1;1;steppedParameters[spPModFil];
+LFO Shape;1;1;1;steppedParameters[spLFOShape];
+(unused, LFO range slot);1;1;1;steppedParameters[spLegacyLFORange];
+LFO Targets;1;1;1;steppedParameters[spLFOTargets];
+Tracking Shift;1;1;1;steppedParameters[spTrackingShift];
+Filter Envelope Shape;1;1;1;steppedParameters[spFilEnvShape];
+Filter Envelope Speed;1;1;1;steppedParameters[spFilEnvSlow];
+Amp Envelope Shape;1;1;1;steppedParameters[spAmpEnvShape];
+Amp Envelope Speed;1;1;1;steppedParameters[holdPedal];
+Unison;1;1;1;steppedParameters[spUnison];
+Assigner Priority;1;1;1;steppedParameters[spAssignerPriority];
+Bender Semitones;1;1;1;steppedParameters[spBenderSemitones];
+Bender Target;1;1;1;steppedParameters[spBenderTarget];
+Modulation Wheel Range;1;1;1;steppedParameters[spModWheelRange];
+Chromatic Pitch;1;1;1;steppedParameters[spChromaticPitch];
+Modulation Delay;1;2;2;continuousParameters[cpModDelay];
+Vibrato Frequency;1;2;2;continuousParameters[cpVibFreq];
+Vibrato Amount;1;2;2;continuousParameters[cpVibAmt];
+Unison Detune;1;2;2;continuousParameters[cpUnisonDetune];
+(unused, arp/seq clock slot);1;2;2;;
+Modulation Wheel Target;1;1;2;steppedParameters[spModwheelTarget];
+Vibrato Target;1;1;2;steppedParameters[spVibTarget];
+Voice Pattern (6 voices);6;1;2;voicePattern;
+Tuning per Note (12 notes);12;2;7;perNoteTuning;
+PW Bug;1;1;8;steppedParameters[spPWMBug];1
+Vintage;1;2;8;continuousParameters[cpSpread];
+Ext Voltage;1;2;8;continuousParameters[cpExternal];
+Envelope Routing;1;1;8;steppedParameters[spEnvRouting];3
+Voice Assigner;1;1;8;steppedParameters[spAssign];1
+LFO Sync;1;1;8;steppedParameters[spLFOSync];7
+Patch Name;16;1;8;patchName;
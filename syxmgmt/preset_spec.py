@@ -0,0 +1,80 @@
+"""Host side of the preset storage layout described in preset.spec.
+
+The firmware loads and saves presets from the same spec (see gen_preset_layout.py),
+so both sides stay in sync when a storage version is added.
+"""
+
+import collections
+import os
+
+STORAGE_MAGIC = 0x006116a5
+HEADER_SIZE = 5 # 4 bytes magic + 1 byte version
+
+DEFAULT_SPEC = os.path.join(os.path.dirname(os.path.abspath(__file__)), "preset.spec")
+
+Field = collections.namedtuple('Field', 'name count size since target max')
+
+
+def load(path=DEFAULT_SPEC):
+    fields = []
+    with open(path, "rt") as f:
+        for lineNo, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            cols = line.split(';') + [''] * 6
+            field = Field(cols[0], int(cols[1]), int(cols[2]), int(cols[3]), cols[4].strip(),
+                          int(cols[5]) if cols[5].strip() else None)
+            if field.size not in (1, 2):
+                raise ValueError('%s:%d: values must be 1 or 2 bytes' % (path, lineNo))
+            if fields and field.since < fields[-1].since:
+                raise ValueError('%s:%d: fields must be sorted by storage version' % (path, lineNo))
+            fields.append(field)
+    return fields
+
+
+def latestVersion(fields):
+    return max(f.since for f in fields)
+
+
+def fieldsForVersion(fields, version):
+    return [f for f in fields if f.since <= version]
+
+
+def decode(page, fields):
+    """page starts with the storage magic; returns (version, [(field, [values])]).
+    Bytes missing at the end (exports drop trailing zeroes) read as zero."""
+
+    def byte(i):
+        return page[i] if i < len(page) else 0
+
+    if len(page) < HEADER_SIZE or (page[0] | page[1] << 8 | page[2] << 16 | page[3] << 24) != STORAGE_MAGIC:
+        raise ValueError('Storage Magic is not found')
+
+    version = page[4]
+    if version > latestVersion(fields):
+        raise ValueError('Unsupported storage version: %d' % version)
+
+    i = HEADER_SIZE
+    values = []
+    for field in fieldsForVersion(fields, version):
+        v = []
+        for cnt in range(field.count):
+            v.append(byte(i) if field.size == 1 else byte(i) | byte(i + 1) << 8)
+            i += field.size
+        values.append((field, v))
+
+    return version, values
+
+
+def encode(values, fields):
+    """values maps field names to lists of values, missing fields and unused slots are written as zero."""
+
+    version = latestVersion(fields)
+    page = bytearray([STORAGE_MAGIC & 0xff, (STORAGE_MAGIC >> 8) & 0xff, (STORAGE_MAGIC >> 16) & 0xff, STORAGE_MAGIC >> 24, version])
+    for field in fields:
+        v = values.get(field.name, []) if field.target else []
+        for cnt in range(field.count):
+            x = v[cnt] if cnt < len(v) else 0
+            page += bytes([x & 0xff]) if field.size == 1 else bytes([x & 0xff, x >> 8])
+    return bytes(page)
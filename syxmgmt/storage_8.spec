@@ -1,64 +0,0 @@
-Frequency A;1;2
-Volume A;1;2
-PWA;1;2
-Frequency B;1;2
-Volume B;1;2
-PWB;1;2
-Frequency Fine B;1;2
-Cutoff;1;2
-Resonance;1;2
-Filter Envelope Amount;1;2
-Filter Release;1;2
-Filter Sustain;1;2
-Filter Decay;1;2
-Filter Attack;1;2
-2nd Release;1;2
-2nd Sustain;1;2
-2nd Decay;1;2
-2nd Attack;1;2
-Poly Mod Envelope Amount;1;2
-Poly Mod OSC B;1;2
-LFO Frequency;1;2
-LFO Amount;1;2
-Glide;1;2
-Amp Velocity;1;2
-Filter Velocity;1;2
-Saw A;1;1
-Tri A;1;1
-SQR A;1;1
-Saw B;1;1
-Tri B;1;1
-SQR B;1;1
-Sync;1;1
-Poly Mod Frequency A;1;1
-Poly Mod Filter;1;1
-LFO Shape;1;1
-(unused, LFO range slot);1;1
-LFO Targets;1;1
-Tracking Shift;1;1
-Filter Envelope Shape;1;1
-Filter Envelope Speed;1;1
-Amp Envelope Shape;1;1
-Amp Envelope Speed;1;1
-Unison;1;1
-Assigner Priority;1;1
-Bender Semitones;1;1
-Bender Target;1;1
-Modulation Wheel Range;1;1
-Chromatic Pitch;1;1
-Modulation Delay;1;2
-Vibrato Frequency;1;2
-Vibrato Amount;1;2
-Unison Detune;1;2
-(unused, arp/seq clock slot);1;2
-Modulation Wheel Target;1;1
-Vibrato Target;1;1
-Voice Pattern (6 voices);6;1
-Tuning per Note (12 notes);12;2
-PW Bug;1;1
-Vintage;1;2
-Ext Voltage;1;2
-Envelope Routing;1;1
-Voice Assigner;1;1
-LFO Sync;1;1
-Patch Name;16;1
@@ -1,6 +1,8 @@
 import collections
 import optparse
 
+import preset_spec
+
 
 parser = optparse.OptionParser()
 #parser.add_option(
@@ -23,20 +25,8 @@ parser.add_option(
 options, args = parser.parse_args()
 
 data = []
-spec7 = []
-spec8 = []
-
-fittingSpec = []
-
-fileVar = open("storage_7.spec","rt")
-for c in fileVar.readlines():
-	spec7.append([c.split(';')[0],int(c.split(';')[1]),int(c.split(';')[2])])
-fileVar.close()
 
-fileVar = open("storage_8.spec","rt")
-for c in fileVar.readlines():
-	spec8.append([c.split(';')[0],int(c.split(';')[1]),int(c.split(';')[2])])
-fileVar.close()
+specFields = preset_spec.load()
 
 fileVar = open(args[0],"rb")
 f = fileVar.read(1)
@@ -123,49 +113,17 @@ for patch in patches:
 
     print('Patch Number: ', patch[0])
 
-    if patch[1]!=165 or patch[2]!=22 or patch[3]!=97 or patch[4]!=0:
-        print('Storage Magic is not found')
-        quit()
-
-
-    if patch[5]==7:
-        fittingSpec=spec7
-        print('Storage version is 7')
-    elif patch[5]==8:
-        fittingSpec=spec8
-        print('Storage version is 8')
-    else:
-        print('Unsupported storage version: ', patch[5])
+    try:
+        version, values = preset_spec.decode(patch[1:], specFields)
+    except ValueError as e:
+        print(e)
         quit()
 
-    i=6
-    msb=0
-    lsb=0
-    for spec in fittingSpec:
-        for cnt in range(0,spec[1]):
-            if spec[2]==2:
-                if i>len(patch)-1:
-                    msb=0
-                    lsb=0
-                elif i+1>len(patch)-1: # assume zero
-                    msb=0
-                    lsb=patch[i]
-                else:
-                    msb=patch[i+1]
-                    lsb=patch[i]
-
-                i+=2
-            else:
-                msb=0
-                if i>len(patch)-1:
-                    lsb=0
-                else:
-                    lsb=patch[i]
-
-                i+=1
+    print('Storage version is', version)
 
-            if spec[1]>1:
-                print(spec[0], '(', cnt+1, ' of ', spec[1],'): ', msb*256+lsb)
+    for spec, v in values:
+        for cnt in range(0,spec.count):
+            if spec.count>1:
+                print(spec.name, '(', cnt+1, ' of ', spec.count,'): ', v[cnt])
             else:
-                print(spec[0], ': ', msb*256+lsb)
-
+                print(spec.name, ': ', v[cnt])
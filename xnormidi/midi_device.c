@@ -96,8 +96,9 @@ void midi_process_byte(MidiDevice * device, uint8_t input) {
       midi_input_callbacks(device, 1, input, 0, 0);
       device->input_state = state;
    } else if (midi_is_statusbyte(input)) {
-      //store the byte
-      if (device->input_state != SYSEX_MESSAGE) {
+      //store the byte, a sysex end keeps the sysex bytes, any other status
+      //byte cuts the sysex short
+      if (device->input_state != SYSEX_MESSAGE || input != SYSEX_END) {
          device->input_buffer[0] = input;
          device->input_count = 1;
       }
@@ -121,6 +122,12 @@ void midi_process_byte(MidiDevice * device, uint8_t input) {
                   device->input_count = 1;
                   break;
                case SYSEX_END:
+                  //ignore a stray end, it would be sent as a data byte
+                  if (device->input_state != SYSEX_MESSAGE) {
+                     device->input_state = IDLE;
+                     device->input_count = 0;
+                     break;
+                  }
                   //send what is left in the input buffer, set idle
                   device->input_buffer[device->input_count % 3] = input;
                   device->input_count += 1;
@@ -705,4 +705,46 @@ void MIDITest::interspersedRealtime() {
    CPPUNIT_ASSERT_EQUAL(MIDI_ACTIVESENSE, (int)callback_data[10].bytes[0]);
 }
 
+void MIDITest::straySysexEnd() {
+   //a sysex end outside of a sysex cancels the pending message like any
+   //system common status, it must not end up as a data byte
+   uint8_t buffer[] = {
+      MIDI_NOTEON, 0x3C, SYSEX_END, 0x40,
+      MIDI_NOTEON, 0x3D, 0x41
+   };
+
+   MidiDevice device;
+   midi_device_init(&device);
+   register_all_callbacks(&device);
+   midi_device_input(&device, sizeof(buffer), buffer);
+
+   midi_device_process(&device);
+   CPPUNIT_ASSERT_EQUAL(1, (int)callback_data.size());
+
+   //the channel is passed, not the status byte
+   CPPUNIT_ASSERT_EQUAL(std::string("noteon"), callback_data[0].type);
+   CPPUNIT_ASSERT_EQUAL(0x0, (int)callback_data[0].bytes[0]);
+   CPPUNIT_ASSERT_EQUAL(0x3D, (int)callback_data[0].bytes[1]);
+   CPPUNIT_ASSERT_EQUAL(0x41, (int)callback_data[0].bytes[2]);
+}
 
+void MIDITest::statusInSysex() {
+   //a status byte cuts a sysex short, the message it starts is parsed from scratch
+   uint8_t buffer[] = {
+      SYSEX_BEGIN, 0x01,
+      MIDI_NOTEON, 0x3C, 0x40
+   };
+
+   MidiDevice device;
+   midi_device_init(&device);
+   register_all_callbacks(&device);
+   midi_device_input(&device, sizeof(buffer), buffer);
+
+   midi_device_process(&device);
+   CPPUNIT_ASSERT_EQUAL(1, (int)callback_data.size());
+
+   CPPUNIT_ASSERT_EQUAL(std::string("noteon"), callback_data[0].type);
+   CPPUNIT_ASSERT_EQUAL(0x0, (int)callback_data[0].bytes[0]);
+   CPPUNIT_ASSERT_EQUAL(0x3C, (int)callback_data[0].bytes[1]);
+   CPPUNIT_ASSERT_EQUAL(0x40, (int)callback_data[0].bytes[2]);
+}
@@ -14,6 +14,8 @@ class MIDITest : public CppUnit::TestCase {
    CPPUNIT_TEST( oneByteCallbacks );
    CPPUNIT_TEST( sysexCallback );
    CPPUNIT_TEST( interspersedRealtime );
+   CPPUNIT_TEST( straySysexEnd );
+   CPPUNIT_TEST( statusInSysex );
    CPPUNIT_TEST_SUITE_END(); 
 
    public:
@@ -27,6 +29,8 @@ class MIDITest : public CppUnit::TestCase {
       void oneByteCallbacks();
       void sysexCallback();
       void interspersedRealtime();
+      void straySysexEnd();
+      void statusInSysex();
 };
 
 #endif
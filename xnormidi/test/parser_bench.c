@@ -0,0 +1,213 @@
+//midi for embedded chips,
+//Copyright 2010 Alex Norman
+//
+//This file is part of avr-midi.
+//
+//avr-midi is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//avr-midi is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with avr-midi.  If not, see <http://www.gnu.org/licenses/>.
+
+//input parser throughput: generates a realistic stream (running status,
+//controllers, clock bytes interleaved inside messages, short sysex dumps) and
+//an adversarial one (random status bytes mid message, truncated and oversize
+//sysex, stray sysex ends, undefined status bytes), then pushes them through
+//the device queue and reports bytes/s and callbacks/s.
+//
+//usage: parser_bench [megabytes per stream] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "midi_device.h"
+#include "midi.h"
+
+//the firmware feeds the queue a few bytes at a time from its UART interrupt
+#define BENCH_CHUNK 16
+
+//bigger than the firmware's sysex buffer
+#define OVERSIZE_SYSEX 20000
+
+typedef struct {
+   uint8_t * data;
+   size_t size, capacity;
+} stream_t;
+
+static uint32_t rng;
+static unsigned long callbacks, sysex_bytes;
+
+static uint32_t xorshift(void) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return rng;
+}
+
+static uint32_t random_below(uint32_t n) {
+   return xorshift() % n;
+}
+
+static void put(stream_t * s, uint8_t b) {
+   if (s->size < s->capacity)
+      s->data[s->size++] = b;
+}
+
+//a clock or active sensing byte now and then, anywhere
+static void put_data(stream_t * s, uint8_t b) {
+   if (!random_below(24))
+      put(s, random_below(4) ? MIDI_CLOCK : MIDI_ACTIVESENSE);
+   put(s, b & 0x7F);
+}
+
+static void put_sysex(stream_t * s, size_t length, int terminated) {
+   size_t i;
+   put(s, SYSEX_BEGIN);
+   for (i = 0; i < length; i++)
+      put_data(s, xorshift());
+   if (terminated)
+      put(s, SYSEX_END);
+}
+
+static void realistic_stream(stream_t * s) {
+   uint8_t running = 0, status, channel = 0;
+
+   while (s->size < s->capacity) {
+      uint32_t r = random_below(100);
+
+      if (r < 2) {
+         //patch dump, breaks running status
+         put_sysex(s, 16 + random_below(400), 1);
+         running = 0;
+         continue;
+      }
+      if (r < 3)
+         channel = random_below(16);
+
+      if (r < 60)
+         status = (random_below(3) ? MIDI_NOTEON : MIDI_NOTEOFF) | channel;
+      else if (r < 80)
+         status = MIDI_CC | channel;
+      else if (r < 92)
+         status = MIDI_PITCHBEND | channel;
+      else if (r < 96)
+         status = MIDI_CHANPRESSURE | channel;
+      else if (r < 98)
+         status = MIDI_AFTERTOUCH | channel;
+      else
+         status = MIDI_PROGCHANGE | channel;
+
+      if (status != running)
+         put(s, status);
+      running = status;
+
+      put_data(s, xorshift());
+      if (midi_packet_length(status) == THREE)
+         put_data(s, xorshift());
+   }
+}
+
+static void adversarial_stream(stream_t * s) {
+   static const uint8_t system[] = {
+      MIDI_TC_QUARTERFRAME, MIDI_SONGPOSITION, MIDI_SONGSELECT, 0xF4, 0xF5,
+      MIDI_TUNEREQUEST, SYSEX_END, 0xF9, 0xFD, MIDI_START, MIDI_STOP, MIDI_RESET
+   };
+
+   while (s->size < s->capacity) {
+      uint32_t r = random_below(100);
+
+      if (r < 50)
+         put_data(s, xorshift());
+      else if (r < 75)
+         put(s, 0x80 | random_below(0x70));
+      else if (r < 90)
+         put(s, system[random_below(sizeof(system))]);
+      else if (r < 98)
+         put_sysex(s, random_below(64), random_below(2));
+      else
+         put_sysex(s, OVERSIZE_SYSEX + random_below(OVERSIZE_SYSEX), random_below(2));
+   }
+}
+
+static void count3(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { callbacks++; }
+static void count2(MidiDevice * d, uint8_t b0, uint8_t b1) { callbacks++; }
+static void count1(MidiDevice * d, uint8_t b0) { callbacks++; }
+
+static void count_sysex(MidiDevice * d, uint16_t cnt, uint8_t b0, uint8_t b1, uint8_t b2) {
+   callbacks++;
+   sysex_bytes += ((cnt - 1) % 3) + 1;
+}
+
+static double seconds(void) {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//the firmware's set of callbacks, and the ones it leaves out
+static void bench(const char * name, const stream_t * s) {
+   MidiDevice device;
+   size_t i, n;
+   double elapsed;
+
+   midi_device_init(&device);
+   midi_register_noteon_callback(&device, count3);
+   midi_register_noteoff_callback(&device, count3);
+   midi_register_cc_callback(&device, count3);
+   midi_register_pitchbend_callback(&device, count3);
+   midi_register_progchange_callback(&device, count2);
+   midi_register_realtime_callback(&device, count1);
+   midi_register_sysex_callback(&device, count_sysex);
+
+   callbacks = sysex_bytes = 0;
+   elapsed = seconds();
+
+   for (i = 0; i < s->size; i += n) {
+      n = s->size - i < BENCH_CHUNK ? s->size - i : BENCH_CHUNK;
+      midi_device_input(&device, n, s->data + i);
+      midi_device_process(&device);
+   }
+
+   elapsed = seconds() - elapsed;
+
+   printf("%-12s %8.2f %10.2f %10.2f %10lu %10lu\n", name, s->size / 1e6, s->size / elapsed / 1e6,
+         callbacks / elapsed / 1e6, callbacks, sysex_bytes);
+}
+
+int main(int argc, char * argv[]) {
+   stream_t s;
+   double megabytes = argc > 1 ? atof(argv[1]) : 16.0;
+
+   rng = argc > 2 ? strtoul(argv[2], NULL, 0) : 1;
+   if (!rng)
+      rng = 1;
+
+   s.capacity = megabytes * 1e6;
+   s.data = malloc(s.capacity);
+   if (!s.data || !s.capacity) {
+      fprintf(stderr, "bad size\n");
+      return 1;
+   }
+
+   printf("%-12s %8s %10s %10s %10s %10s\n", "stream", "MB", "MB/s", "Mcb/s", "callbacks", "sysex");
+
+   s.size = 0;
+   realistic_stream(&s);
+   bench("realistic", &s);
+
+   s.size = 0;
+   adversarial_stream(&s);
+   bench("adversarial", &s);
+
+   free(s.data);
+   return 0;
+}
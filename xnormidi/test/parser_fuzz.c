@@ -0,0 +1,299 @@
+//midi for embedded chips,
+//Copyright 2010 Alex Norman
+//
+//This file is part of avr-midi.
+//
+//avr-midi is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+//
+//avr-midi is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+//
+//You should have received a copy of the GNU General Public License
+//along with avr-midi.  If not, see <http://www.gnu.org/licenses/>.
+
+//libFuzzer target for the input parser: every input is pushed through the
+//device queue and the callbacks it triggers are compared with those of a
+//plain reference parser below.
+//
+//Built with FUZZ_STANDALONE, a main() replays the files given as arguments,
+//or random biased streams when there are none, for compilers without libFuzzer.
+//
+//Inputs must stay under 64k bytes, the parser's sysex count is 16 bits.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "midi_device.h"
+#include "midi.h"
+
+#define FUZZ_CHUNK 64
+
+typedef enum {
+   ev_cc, ev_noteon, ev_noteoff, ev_aftertouch, ev_pitchbend, ev_songposition,
+   ev_progchange, ev_chanpressure, ev_songselect, ev_quarterframe,
+   ev_realtime, ev_tunerequest, ev_sysex, ev_fallthrough
+} event_kind_t;
+
+typedef struct {
+   uint8_t kind;
+   uint8_t byte0, byte1, byte2;
+   uint16_t cnt; //sysex and fallthrough only
+} event_t;
+
+typedef struct {
+   event_t * events;
+   size_t count;
+} event_log_t;
+
+static event_log_t parsed;
+
+static void log_event(event_log_t * log, uint8_t kind, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+   event_t * e = &log->events[log->count++];
+   e->kind = kind;
+   e->cnt = cnt;
+   e->byte0 = byte0;
+   e->byte1 = byte1;
+   e->byte2 = byte2;
+}
+
+//sysex callbacks get 3 bytes, only the ones counted in cnt are meaningful
+static void log_sysex(event_log_t * log, uint16_t cnt, const uint8_t * chunk) {
+   uint8_t valid = ((cnt - 1) % 3) + 1;
+   log_event(log, ev_sysex, cnt, chunk[0], valid > 1 ? chunk[1] : 0, valid > 2 ? chunk[2] : 0);
+}
+
+static void cc_cb(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(&parsed, ev_cc, 0, b0, b1, b2); }
+static void noteon_cb(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(&parsed, ev_noteon, 0, b0, b1, b2); }
+static void noteoff_cb(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(&parsed, ev_noteoff, 0, b0, b1, b2); }
+static void aftertouch_cb(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(&parsed, ev_aftertouch, 0, b0, b1, b2); }
+static void pitchbend_cb(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(&parsed, ev_pitchbend, 0, b0, b1, b2); }
+static void songposition_cb(MidiDevice * d, uint8_t b0, uint8_t b1, uint8_t b2) { log_event(&parsed, ev_songposition, 0, b0, b1, b2); }
+static void progchange_cb(MidiDevice * d, uint8_t b0, uint8_t b1) { log_event(&parsed, ev_progchange, 0, b0, b1, 0); }
+static void chanpressure_cb(MidiDevice * d, uint8_t b0, uint8_t b1) { log_event(&parsed, ev_chanpressure, 0, b0, b1, 0); }
+static void songselect_cb(MidiDevice * d, uint8_t b0, uint8_t b1) { log_event(&parsed, ev_songselect, 0, b0, b1, 0); }
+static void quarterframe_cb(MidiDevice * d, uint8_t b0, uint8_t b1) { log_event(&parsed, ev_quarterframe, 0, b0, b1, 0); }
+static void realtime_cb(MidiDevice * d, uint8_t b0) { log_event(&parsed, ev_realtime, 0, b0, 0, 0); }
+static void tunerequest_cb(MidiDevice * d, uint8_t b0) { log_event(&parsed, ev_tunerequest, 0, b0, 0, 0); }
+
+static void sysex_cb(MidiDevice * d, uint16_t cnt, uint8_t b0, uint8_t b1, uint8_t b2) {
+   uint8_t chunk[3] = {b0, b1, b2};
+   log_sysex(&parsed, cnt, chunk);
+}
+
+static void fallthrough_cb(MidiDevice * d, uint16_t cnt, uint8_t b0, uint8_t b1, uint8_t b2) {
+   log_event(&parsed, ev_fallthrough, cnt, b0, b1, b2);
+}
+
+static uint8_t message_kind(uint8_t status) {
+   switch (status) {
+      case MIDI_SONGPOSITION:
+         return ev_songposition;
+      case MIDI_SONGSELECT:
+         return ev_songselect;
+      case MIDI_TC_QUARTERFRAME:
+         return ev_quarterframe;
+   }
+   switch (status & 0xF0) {
+      case MIDI_CC:
+         return ev_cc;
+      case MIDI_NOTEON:
+         return ev_noteon;
+      case MIDI_NOTEOFF:
+         return ev_noteoff;
+      case MIDI_AFTERTOUCH:
+         return ev_aftertouch;
+      case MIDI_PITCHBEND:
+         return ev_pitchbend;
+      case MIDI_PROGCHANGE:
+         return ev_progchange;
+      default:
+         return ev_chanpressure;
+   }
+}
+
+//what the parser must do: realtime bytes go through anywhere, channel and
+//system common messages keep running status, any other status byte cuts a
+//sysex short (the bytes of its last partial chunk are lost), stray sysex
+//ends and undefined status bytes reset to idle
+static void reference_parse(const uint8_t * data, size_t size, event_log_t * log) {
+   uint8_t status = 0, need = 0, have = 0, message[2];
+   uint8_t in_sysex = 0, chunk[3] = {0, 0, 0};
+   uint16_t sysex_count = 0;
+   size_t i;
+
+   for (i = 0; i < size; i++) {
+      uint8_t b = data[i];
+
+      if (b >= MIDI_CLOCK) {
+         log_event(log, ev_realtime, 0, b, 0, 0);
+      } else if (b & 0x80) {
+         if (b == SYSEX_END && in_sysex) {
+            chunk[sysex_count % 3] = b;
+            sysex_count++;
+            log_sysex(log, sysex_count, chunk);
+         }
+         in_sysex = 0;
+         status = 0;
+         have = 0;
+
+         if (b == SYSEX_BEGIN) {
+            in_sysex = 1;
+            chunk[0] = b;
+            sysex_count = 1;
+         } else if (b == MIDI_TUNEREQUEST) {
+            log_event(log, ev_tunerequest, 0, b, 0, 0);
+         } else if (b < 0xF0 || b == MIDI_SONGPOSITION || b == MIDI_SONGSELECT || b == MIDI_TC_QUARTERFRAME) {
+            status = b;
+            need = (b == MIDI_SONGPOSITION || (b < 0xF0 && (b & 0xF0) != MIDI_PROGCHANGE && (b & 0xF0) != MIDI_CHANPRESSURE)) ? 2 : 1;
+         }
+      } else if (in_sysex) {
+         chunk[sysex_count % 3] = b;
+         sysex_count++;
+         if (sysex_count % 3 == 0)
+            log_sysex(log, sysex_count, chunk);
+      } else if (status) {
+         message[have++] = b;
+         if (have == need) {
+            uint8_t byte0 = status >= 0xF0 ? status : status & 0x0F;
+            log_event(log, message_kind(status), 0, byte0, message[0], need > 1 ? message[1] : 0);
+            have = 0;
+         }
+      }
+   }
+}
+
+static void report(const uint8_t * data, size_t size, const event_log_t * expected, size_t at) {
+   size_t i;
+
+   fprintf(stderr, "parser/reference mismatch at event %lu of %lu (parser sent %lu)\n",
+         (unsigned long)at, (unsigned long)expected->count, (unsigned long)parsed.count);
+   if (at < expected->count)
+      fprintf(stderr, "  expected kind %d cnt %d: %02X %02X %02X\n", expected->events[at].kind, expected->events[at].cnt,
+            expected->events[at].byte0, expected->events[at].byte1, expected->events[at].byte2);
+   if (at < parsed.count)
+      fprintf(stderr, "  parsed   kind %d cnt %d: %02X %02X %02X\n", parsed.events[at].kind, parsed.events[at].cnt,
+            parsed.events[at].byte0, parsed.events[at].byte1, parsed.events[at].byte2);
+   fprintf(stderr, "  input:");
+   for (i = 0; i < size && i < 256; i++)
+      fprintf(stderr, " %02X", data[i]);
+   fprintf(stderr, "%s\n", size > 256 ? " ..." : "");
+   abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t * data, size_t size) {
+   MidiDevice device;
+   event_log_t expected;
+   size_t i, n;
+
+   if (size >= 0xFFFF)
+      return 0;
+
+   //at most one callback per byte
+   parsed.events = malloc((size + 1) * sizeof(event_t));
+   expected.events = malloc((size + 1) * sizeof(event_t));
+   parsed.count = expected.count = 0;
+
+   midi_device_init(&device);
+   midi_register_cc_callback(&device, cc_cb);
+   midi_register_noteon_callback(&device, noteon_cb);
+   midi_register_noteoff_callback(&device, noteoff_cb);
+   midi_register_aftertouch_callback(&device, aftertouch_cb);
+   midi_register_pitchbend_callback(&device, pitchbend_cb);
+   midi_register_songposition_callback(&device, songposition_cb);
+   midi_register_progchange_callback(&device, progchange_cb);
+   midi_register_chanpressure_callback(&device, chanpressure_cb);
+   midi_register_songselect_callback(&device, songselect_cb);
+   midi_register_tc_quarterframe_callback(&device, quarterframe_cb);
+   midi_register_realtime_callback(&device, realtime_cb);
+   midi_register_tunerequest_callback(&device, tunerequest_cb);
+   midi_register_sysex_callback(&device, sysex_cb);
+   midi_register_fallthrough_callback(&device, fallthrough_cb);
+
+   //same path as the firmware: bytes queued, then processed
+   for (i = 0; i < size; i += n) {
+      n = size - i < FUZZ_CHUNK ? size - i : FUZZ_CHUNK;
+      midi_device_input(&device, n, (uint8_t *)data + i);
+      midi_device_process(&device);
+   }
+
+   reference_parse(data, size, &expected);
+
+   for (i = 0; i < expected.count && i < parsed.count; i++)
+      if (memcmp(&expected.events[i], &parsed.events[i], sizeof(event_t)))
+         break;
+   if (i < expected.count || i < parsed.count)
+      report(data, size, &expected, i);
+
+   free(parsed.events);
+   free(expected.events);
+   return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+
+#define RANDOM_INPUTS 200000
+#define RANDOM_MAX_SIZE 512
+
+static uint32_t rng = 1;
+
+static uint32_t xorshift(void) {
+   rng ^= rng << 13;
+   rng ^= rng >> 17;
+   rng ^= rng << 5;
+   return rng;
+}
+
+//mostly data bytes, status bytes often enough to cut every kind of message
+static uint8_t random_byte(void) {
+   uint32_t r = xorshift();
+   switch (r % 8) {
+      case 0:
+         return 0x80 | (r >> 8);
+      case 1:
+         return 0xF0 | ((r >> 8) & 0x0F);
+      default:
+         return (r >> 8) & 0x7F;
+   }
+}
+
+int main(int argc, char * argv[]) {
+   static uint8_t buffer[0xFFFF];
+   size_t size;
+   long n;
+   int i;
+
+   for (i = 1; i < argc; i++) {
+      FILE * f = fopen(argv[i], "rb");
+      if (!f) {
+         perror(argv[i]);
+         return 1;
+      }
+      size = fread(buffer, 1, sizeof(buffer), f);
+      fclose(f);
+      LLVMFuzzerTestOneInput(buffer, size);
+   }
+
+   if (argc > 1) {
+      printf("%d inputs ok\n", argc - 1);
+      return 0;
+   }
+
+   for (n = 0; n < RANDOM_INPUTS; n++) {
+      size = xorshift() % RANDOM_MAX_SIZE;
+      for (i = 0; i < size; i++)
+         buffer[i] = random_byte();
+      LLVMFuzzerTestOneInput(buffer, size);
+   }
+
+   printf("%ld random inputs ok\n", n);
+   return 0;
+}
+
+#endif